@@ -0,0 +1,93 @@
+#ifndef ALIGNED_ALLOCATOR_HPP
+#define ALIGNED_ALLOCATOR_HPP
+
+#include <new>
+#include <cstddef>
+#include <cstdlib>
+
+namespace ft
+{
+    // Allocator whose buffers start on an Align-byte boundary (a cache line
+    // by default), so SIMD kernels over a vector's data() can use aligned
+    // loads and no vector straddles a line it does not need to. Align must be
+    // a power of two; it is never lowered below the alignment of T.
+    template <class T, size_t Align = 64>
+    class aligned_allocator
+    {
+    public:
+        typedef T         value_type;
+        typedef T*        pointer;
+        typedef const T*  const_pointer;
+        typedef T&        reference;
+        typedef const T&  const_reference;
+        typedef size_t    size_type;
+        typedef ptrdiff_t difference_type;
+
+        static const size_t alignment = Align > __alignof__(T) ? Align : __alignof__(T);
+
+        template <class U>
+        struct rebind
+        {
+            typedef aligned_allocator<U, Align> other;
+        };
+
+    private:
+        typedef char _alignment_must_be_a_power_of_two[(Align & (Align - 1)) == 0 ? 1 : -1];
+
+        // posix_memalign also wants a multiple of sizeof(void*)
+        static const size_t _request = alignment > sizeof(void*) ? alignment : sizeof(void*);
+
+    public:
+        aligned_allocator() {}
+        aligned_allocator(const aligned_allocator &) {}
+        template <class U>
+        aligned_allocator(const aligned_allocator<U, Align> &) {}
+
+        pointer address(reference x) const { return &x; }
+        const_pointer address(const_reference x) const { return &x; }
+
+        pointer allocate(size_type n, const void * = 0)
+        {
+            if (n > max_size())
+                throw std::bad_alloc();
+
+            void *p = NULL;
+            if (posix_memalign(&p, _request, n ? n * sizeof(T) : 1) != 0)
+                throw std::bad_alloc();
+            return static_cast<pointer>(p);
+        }
+
+        void deallocate(pointer p, size_type) { free(p); }
+
+        size_type max_size() const { return size_type(-1) / sizeof(T); }
+
+        void construct(pointer p, const_reference val) { new (static_cast<void*>(p)) T(val); }
+
+        void destroy(pointer p) { p->~T(); }
+
+        friend bool operator==(const aligned_allocator &, const aligned_allocator &) { return true; }
+        friend bool operator!=(const aligned_allocator &, const aligned_allocator &) { return false; }
+    };
+
+    template <class T, size_t Align>
+    const size_t aligned_allocator<T, Align>::alignment;
+
+    template <class T, size_t Align>
+    const size_t aligned_allocator<T, Align>::_request;
+
+    // Alignment an allocator guarantees for the buffers it returns. Allocators
+    // that promise nothing more are only trusted with alignof(value_type).
+    template <class Alloc>
+    struct allocator_alignment
+    {
+        static const size_t value = __alignof__(typename Alloc::value_type);
+    };
+
+    template <class T, size_t Align>
+    struct allocator_alignment< aligned_allocator<T, Align> >
+    {
+        static const size_t value = aligned_allocator<T, Align>::alignment;
+    };
+}
+
+#endif // ALIGNED_ALLOCATOR_HPP
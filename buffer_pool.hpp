@@ -0,0 +1,200 @@
+#ifndef BUFFER_POOL_HPP
+#define BUFFER_POOL_HPP
+
+#include <new>
+#include <cstddef>
+#include <pthread.h>
+
+namespace ft
+{
+    // Per-thread cache of released buffers, bucketed by power-of-two size
+    // class. A buffer released on one thread is reused by the next request
+    // of the same class on that thread; anything over the largest class or
+    // past max_cached buffers per class goes straight back to operator delete.
+    // A thread's cache is freed when the thread exits.
+    class buffer_pool
+    {
+    public:
+        static const size_t min_class = 6;   // 64 bytes
+        static const size_t max_class = 22;  // 4 MiB
+        static const size_t max_cached = 8;  // buffers kept per class
+
+        // Returns at least bytes bytes; pair with release(p, bytes)
+        static void *acquire(size_t bytes)
+        {
+            size_t cls = _class_of(bytes);
+            if (cls > max_class)
+                return ::operator new(bytes);
+
+            cache &c = _local();
+            if (c.heads[cls])
+            {
+                _block *b = c.heads[cls];
+                c.heads[cls] = b->next;
+                --c.counts[cls];
+                return b;
+            }
+            return ::operator new(size_t(1) << cls);
+        }
+
+        static void release(void *p, size_t bytes)
+        {
+            if (!p)
+                return;
+
+            size_t cls = _class_of(bytes);
+            if (cls > max_class)
+            {
+                ::operator delete(p);
+                return;
+            }
+
+            cache &c = _local();
+            if (c.counts[cls] >= max_cached)
+            {
+                ::operator delete(p);
+                return;
+            }
+            _block *b = static_cast<_block*>(p);
+            b->next = c.heads[cls];
+            c.heads[cls] = b;
+            ++c.counts[cls];
+        }
+
+        // Frees every buffer cached by the calling thread
+        static void trim() { _drain(&_local()); }
+
+        // Bytes currently cached by the calling thread
+        static size_t cached_bytes()
+        {
+            cache &c = _local();
+            size_t total = 0;
+            for (size_t cls = min_class; cls <= max_class; ++cls)
+                total += c.counts[cls] << cls;
+            return total;
+        }
+
+    private:
+        struct _block
+        {
+            _block *next;
+        };
+
+        struct cache
+        {
+            _block *heads[max_class + 1];
+            size_t counts[max_class + 1];
+            bool   registered;
+        };
+
+        static size_t _class_of(size_t bytes)
+        {
+            size_t cls = min_class;
+            while (cls <= max_class && (size_t(1) << cls) < bytes)
+                ++cls;
+            return cls;
+        }
+
+        static void _drain(void *arg)
+        {
+            cache *c = static_cast<cache*>(arg);
+            for (size_t cls = min_class; cls <= max_class; ++cls)
+            {
+                while (c->heads[cls])
+                {
+                    _block *b = c->heads[cls];
+                    c->heads[cls] = b->next;
+                    ::operator delete(b);
+                }
+                c->counts[cls] = 0;
+            }
+        }
+
+        static void _on_thread_exit(void *arg)
+        {
+            _drain(arg);
+            static_cast<cache*>(arg)->registered = false;
+        }
+
+        static pthread_key_t _key()
+        {
+            static pthread_once_t once = PTHREAD_ONCE_INIT;
+            pthread_once(&once, &buffer_pool::_create_key);
+            return _key_storage();
+        }
+
+        static pthread_key_t &_key_storage()
+        {
+            static pthread_key_t key;
+            return key;
+        }
+
+        static void _create_key() { pthread_key_create(&_key_storage(), &buffer_pool::_on_thread_exit); }
+
+        // The cache is plain thread-local data; the pthread key only exists
+        // so that its destructor drains the cache when the thread exits
+        static cache &_local()
+        {
+            static __thread cache c;
+            if (!c.registered)
+            {
+                pthread_setspecific(_key(), &c);
+                c.registered = true;
+            }
+            return c;
+        }
+    };
+
+    // Allocator that takes its buffers from buffer_pool, for containers that
+    // are created and destroyed at similar sizes over and over:
+    // ft::vector<int, ft::buffer_pool_allocator<int> >. Requests are rounded
+    // up to the size class, so a reserve() of a recently freed size reuses
+    // that buffer instead of calling malloc.
+    template <class T>
+    class buffer_pool_allocator
+    {
+    public:
+        typedef T         value_type;
+        typedef T*        pointer;
+        typedef const T*  const_pointer;
+        typedef T&        reference;
+        typedef const T&  const_reference;
+        typedef size_t    size_type;
+        typedef ptrdiff_t difference_type;
+
+        template <class U>
+        struct rebind
+        {
+            typedef buffer_pool_allocator<U> other;
+        };
+
+        buffer_pool_allocator() {}
+        buffer_pool_allocator(const buffer_pool_allocator &) {}
+        template <class U>
+        buffer_pool_allocator(const buffer_pool_allocator<U> &) {}
+
+        pointer address(reference x) const { return &x; }
+        const_pointer address(const_reference x) const { return &x; }
+
+        pointer allocate(size_type n, const void * = 0)
+        {
+            if (n > max_size())
+                throw std::bad_alloc();
+            return static_cast<pointer>(buffer_pool::acquire(n * sizeof(T)));
+        }
+
+        void deallocate(pointer p, size_type n) { buffer_pool::release(p, n * sizeof(T)); }
+
+        size_type max_size() const { return size_type(-1) / sizeof(T); }
+
+        void construct(pointer p, const_reference val) { new (static_cast<void*>(p)) T(val); }
+
+        void destroy(pointer p) { p->~T(); }
+
+        // Every instance shares the same pool
+        friend bool operator==(const buffer_pool_allocator &, const buffer_pool_allocator &) { return true; }
+        friend bool operator!=(const buffer_pool_allocator &, const buffer_pool_allocator &) { return false; }
+    };
+}
+
+#endif // BUFFER_POOL_HPP
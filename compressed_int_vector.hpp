@@ -0,0 +1,386 @@
+#ifndef COMPRESSED_INT_VECTOR_HPP
+#define COMPRESSED_INT_VECTOR_HPP
+
+#include <stdexcept>
+#include <cstddef>
+#include "iterator.hpp"
+#include "vector.hpp"
+#include "simd.hpp"
+
+namespace ft
+{
+    template <class T, size_t BlockSize> class compressed_int_vector;
+
+    // Forward iterator that decodes one delta per step. Elements exist only
+    // decoded, so operator* returns them by value and what it returned
+    // stays valid across ++; operator-> points into the iterator itself.
+    template <class T, size_t BlockSize>
+    class compressed_int_vector_iterator
+        : public ft::iterator<std::forward_iterator_tag, T, ptrdiff_t, const T*, T>
+    {
+    public:
+        typedef T         reference;
+        typedef const T*  pointer;
+        typedef ptrdiff_t difference_type;
+
+    private:
+        typedef compressed_int_vector<T, BlockSize> container_type;
+
+        const container_type *_cont;
+        size_t               _index;
+        T                    _value;
+        size_t               _bitpos;
+        unsigned             _width;
+
+        friend class compressed_int_vector<T, BlockSize>;
+
+        compressed_int_vector_iterator(const container_type *cont, size_t index)
+            : _cont(cont), _index(index), _value(), _bitpos(0), _width(0)
+        {
+            _load();
+        }
+
+        // Decodes the element at _index from scratch
+        void _load()
+        {
+            if (_index >= _cont->size())
+                return;
+            if (_index >= _cont->_packed_size())
+            {
+                _value = _cont->_tail[_index - _cont->_packed_size()];
+                return;
+            }
+
+            const typename container_type::block_header &h = _cont->_blocks[_index / BlockSize];
+            _value = h.first;
+            _bitpos = h.offset;
+            _width = h.width;
+            for (size_t i = _index % BlockSize; i; --i)
+            {
+                _value += _cont->_read(_bitpos, _width);
+                _bitpos += _width;
+            }
+        }
+
+    public:
+        compressed_int_vector_iterator() : _cont(NULL), _index(0), _value(), _bitpos(0), _width(0) {}
+
+        reference operator*() const { return _value; }
+        pointer operator->() const { return &_value; }
+
+        compressed_int_vector_iterator &operator++()
+        {
+            ++_index;
+            if (_index >= _cont->_packed_size() || _index % BlockSize == 0)
+                _load();
+            else
+            {
+                _value += _cont->_read(_bitpos, _width);
+                _bitpos += _width;
+            }
+            return *this;
+        }
+
+        compressed_int_vector_iterator operator++(int)
+        {
+            compressed_int_vector_iterator tmp(*this);
+            ++(*this);
+            return tmp;
+        }
+
+        // Position of the element in the sequence
+        size_t index() const { return _index; }
+
+        friend bool operator==(const compressed_int_vector_iterator &lhs, const compressed_int_vector_iterator &rhs)
+        {
+            return lhs._index == rhs._index;
+        }
+
+        friend bool operator!=(const compressed_int_vector_iterator &lhs, const compressed_int_vector_iterator &rhs)
+        {
+            return lhs._index != rhs._index;
+        }
+    };
+
+    // Append-only sequence of non-decreasing unsigned integers (sorted IDs,
+    // posting lists). Every BlockSize values form a block that keeps its first
+    // value in the skip index and the differences to the previous value
+    // bit-packed with the width of the largest one. The newest values wait
+    // uncompressed in a tail until a block fills up.
+    template <class T, size_t BlockSize = 128>
+    class compressed_int_vector
+    {
+    public:
+        typedef T                                                 value_type;
+        typedef size_t                                            size_type;
+        typedef ptrdiff_t                                         difference_type;
+        typedef T                                                 const_reference;
+        typedef compressed_int_vector_iterator<T, BlockSize>      const_iterator;
+        typedef const_iterator                                    iterator;
+
+        static const size_type block_size = BlockSize;
+
+    private:
+        // Deltas are shifted and masked as raw bits. With a signed T a
+        // delta can overflow to a negative value, which never shifts down
+        // to zero in _bit_width, so only unsigned types are accepted.
+        typedef char _value_type_must_be_unsigned[T(-1) > T(0) ? 1 : -1];
+
+        typedef unsigned long word_type;
+
+        static const unsigned word_bits = sizeof(word_type) * 8;
+
+        struct block_header
+        {
+            T        first;
+            size_t   offset;
+            unsigned width;
+        };
+
+        ft::vector<block_header> _blocks;
+        ft::vector<word_type>    _words;
+        ft::vector<T>            _tail;
+        size_t                   _bits;
+
+        friend class compressed_int_vector_iterator<T, BlockSize>;
+
+        size_type _packed_size() const { return _blocks.size() * BlockSize; }
+
+        static unsigned _bit_width(T x)
+        {
+            unsigned width = 0;
+            for (; x; x >>= 1)
+                ++width;
+            return width;
+        }
+
+        static word_type _low_mask(unsigned n)
+        {
+            return n >= word_bits ? ~word_type(0) : (word_type(1) << n) - 1;
+        }
+
+        T _read(size_t pos, unsigned width) const
+        {
+            T value = 0;
+            unsigned done = 0;
+            while (done < width)
+            {
+                unsigned shift = pos % word_bits;
+                unsigned take = width - done < word_bits - shift ? width - done : word_bits - shift;
+                word_type chunk = (_words[pos / word_bits] >> shift) & _low_mask(take);
+                value |= static_cast<T>(chunk) << done;
+                done += take;
+                pos += take;
+            }
+            return value;
+        }
+
+        void _write(T value, unsigned width)
+        {
+            while (width)
+            {
+                unsigned shift = _bits % word_bits;
+                unsigned take = width < word_bits - shift ? width : word_bits - shift;
+                if (shift == 0)
+                    _words.push_back(0);
+                _words.back() |= (static_cast<word_type>(value) & _low_mask(take)) << shift;
+                if (take < sizeof(T) * 8)
+                    value >>= take;
+                width -= take;
+                _bits += take;
+            }
+        }
+
+        // Packs the full tail into a new block
+        void _flush()
+        {
+            T widest = 0;
+            for (size_type i = 1; i < BlockSize; ++i)
+                widest |= _tail[i] - _tail[i - 1];
+
+            block_header h;
+            h.first = _tail[0];
+            h.offset = _bits;
+            h.width = _bit_width(widest);
+
+            size_type words = _words.size();
+            size_t bits = _bits;
+            try
+            {
+                for (size_type i = 1; i < BlockSize; ++i)
+                    _write(_tail[i] - _tail[i - 1], h.width);
+                _blocks.push_back(h);
+            }
+            catch (...)
+            {
+                _words.resize(words);
+                if (bits % word_bits)
+                    _words.back() &= _low_mask(bits % word_bits);
+                _bits = bits;
+                throw;
+            }
+            _tail.clear();
+        }
+
+    public:
+        // Constructors
+        compressed_int_vector() : _blocks(), _words(), _tail(), _bits(0) {}
+
+        template <class InputIterator>
+        compressed_int_vector(InputIterator first, InputIterator last,
+                              typename ft::enable_if<!ft::is_integral<InputIterator>::value, InputIterator>::type* = 0)
+            : _blocks(), _words(), _tail(), _bits(0)
+        {
+            for (; first != last; ++first)
+                push_back(*first);
+        }
+
+        // Iterators
+        const_iterator begin() const { return const_iterator(this, 0); }
+        const_iterator end() const { return const_iterator(this, size()); }
+
+        // Capacity
+        size_type size() const { return _packed_size() + _tail.size(); }
+
+        bool empty() const { return size() == 0; }
+
+        size_type block_count() const { return _blocks.size(); }
+
+        // Bytes held by the encoded values, skip index and tail
+        size_type memory_usage() const
+        {
+            return _blocks.capacity() * sizeof(block_header)
+                   + _words.capacity() * sizeof(word_type)
+                   + _tail.capacity() * sizeof(T);
+        }
+
+        void shrink_to_fit()
+        {
+            _blocks.shrink_to_fit();
+            _words.shrink_to_fit();
+            _tail.shrink_to_fit();
+        }
+
+        // Element access; decodes up to BlockSize - 1 deltas
+        value_type operator[](size_type n) const { return *const_iterator(this, n); }
+
+        value_type at(size_type n) const
+        {
+            if (n >= size())
+                throw std::out_of_range("compressed_int_vector::at");
+            return (*this)[n];
+        }
+
+        value_type front() const { return _blocks.empty() ? _tail.front() : _blocks.front().first; }
+
+        value_type back() const
+        {
+            if (!_tail.empty())
+                return _tail.back();
+            return (*this)[size() - 1];
+        }
+
+        // Lookup
+        // First element not less than val: binary search over the skip index,
+        // then a sequential decode of at most one block and the tail
+        const_iterator lower_bound(const value_type &val) const
+        {
+            size_type lo = 0;
+            size_type hi = _blocks.size();
+            while (lo < hi)
+            {
+                size_type mid = lo + (hi - lo) / 2;
+                if (_blocks[mid].first < val)
+                    lo = mid + 1;
+                else
+                    hi = mid;
+            }
+
+            const_iterator it(this, lo ? (lo - 1) * BlockSize : 0);
+            const_iterator last = end();
+            while (it != last && *it < val)
+                ++it;
+            return it;
+        }
+
+        bool contains(const value_type &val) const
+        {
+            const_iterator it = lower_bound(val);
+            return it != end() && !(val < *it);
+        }
+
+        // Bulk decode
+        // Writes the values of block b to out and returns how many there were;
+        // the index past the last packed block designates the tail
+        size_type decode_block(size_type b, value_type *out) const
+        {
+            if (b >= _blocks.size())
+            {
+                for (size_type i = 0; i < _tail.size(); ++i)
+                    out[i] = _tail[i];
+                return _tail.size();
+            }
+
+            const block_header &h = _blocks[b];
+            size_t pos = h.offset;
+            out[0] = h.first;
+            for (size_type i = 1; i < BlockSize; ++i, pos += h.width)
+                out[i] = _read(pos, h.width);
+            simd::prefix_sum(out + 1, BlockSize - 1, h.first);
+            return BlockSize;
+        }
+
+        // Writes every value to out[0, size())
+        size_type decode(value_type *out) const
+        {
+            size_type n = 0;
+            for (size_type b = 0; b <= _blocks.size(); ++b)
+                n += decode_block(b, out + n);
+            return n;
+        }
+
+        // Modifiers
+        // Values must arrive in non-decreasing order
+        void push_back(const value_type &val)
+        {
+            if (!empty() && val < back())
+                throw std::invalid_argument("compressed_int_vector::push_back: unsorted value");
+
+            _tail.push_back(val);
+            if (_tail.size() == BlockSize)
+            {
+                try
+                {
+                    _flush();
+                }
+                catch (...)
+                {
+                    _tail.pop_back();
+                    throw;
+                }
+            }
+        }
+
+        void clear()
+        {
+            _blocks.clear();
+            _words.clear();
+            _tail.clear();
+            _bits = 0;
+        }
+
+        void swap(compressed_int_vector &x)
+        {
+            _blocks.swap(x._blocks);
+            _words.swap(x._words);
+            _tail.swap(x._tail);
+            ft::swap(_bits, x._bits);
+        }
+    };
+
+    template <class T, size_t BlockSize>
+    const typename compressed_int_vector<T, BlockSize>::size_type
+    compressed_int_vector<T, BlockSize>::block_size;
+}
+
+#endif // COMPRESSED_INT_VECTOR_HPP
@@ -0,0 +1,282 @@
+#ifndef CONCURRENT_VECTOR_HPP
+#define CONCURRENT_VECTOR_HPP
+
+#include <memory>
+#include <stdexcept>
+#include <cstddef>
+#include "iterator.hpp"
+
+namespace ft
+{
+    // Grow-only vector that any number of threads may push_back into and read
+    // from at the same time without locks. Storage is a fixed table of
+    // segments of doubling size (first_segment, 2 * first_segment, ...), so
+    // growing never moves an element and references stay valid.
+    //
+    // push_back claims an index with an atomic increment, opens the segment if
+    // needed (racing openers keep the first one installed), constructs the
+    // element and publishes it. size() is the length of the published prefix:
+    // every index below it may be read from any thread. A thread may also read
+    // an index it got back from push_back straight away.
+    //
+    // If the element's copy constructor throws, its index stays a hole that
+    // constructed() reports and at() refuses. If opening a segment throws
+    // bad_alloc, size() stops advancing past that index; reserve() opens
+    // segments ahead of time for callers that cannot afford that.
+    //
+    // clear(), swap and destruction must not overlap with any other call.
+    template <class T, class Alloc = std::allocator<T> >
+    class concurrent_vector
+    {
+    public:
+        typedef T                                        value_type;
+        typedef Alloc                                    allocator_type;
+        typedef typename allocator_type::reference       reference;
+        typedef typename allocator_type::const_reference const_reference;
+        typedef typename allocator_type::pointer         pointer;
+        typedef typename allocator_type::const_pointer   const_pointer;
+        typedef ptrdiff_t                                difference_type;
+        typedef size_t                                   size_type;
+
+        static const size_type first_segment = 32;
+
+    private:
+        enum { _pending = 0, _constructed = 1, _failed = 2 };
+
+        struct _segment
+        {
+            pointer       data;
+            unsigned char *state;
+        };
+
+        typedef typename allocator_type::template rebind<_segment>::other      segment_allocator_type;
+        typedef typename allocator_type::template rebind<unsigned char>::other state_allocator_type;
+
+        static const size_type _max_segments = sizeof(size_type) * 8;
+
+        allocator_type _alloc;
+        _segment       *_segments[_max_segments];
+        size_type      _claimed;
+        size_type      _size;
+
+        concurrent_vector(const concurrent_vector &);
+        concurrent_vector &operator=(const concurrent_vector &);
+
+        // Segment k holds first_segment << k elements starting at
+        // first_segment * (2^k - 1)
+        static size_type _segment_of(size_type i)
+        {
+            size_type j = i / first_segment + 1;
+            size_type k = 0;
+            while (j >>= 1)
+                ++k;
+            return k;
+        }
+
+        static size_type _segment_start(size_type k) { return first_segment * ((size_type(1) << k) - 1); }
+
+        static size_type _segment_size(size_type k) { return first_segment << k; }
+
+        _segment *_new_segment(size_type k)
+        {
+            segment_allocator_type seg_alloc(_alloc);
+            state_allocator_type state_alloc(_alloc);
+            size_type n = _segment_size(k);
+
+            _segment *s = seg_alloc.allocate(1);
+            s->data = NULL;
+            s->state = NULL;
+            try
+            {
+                s->data = _alloc.allocate(n);
+                s->state = state_alloc.allocate(n);
+            }
+            catch (...)
+            {
+                if (s->data)
+                    _alloc.deallocate(s->data, n);
+                seg_alloc.deallocate(s, 1);
+                throw;
+            }
+            for (size_type i = 0; i < n; ++i)
+                s->state[i] = _pending;
+            return s;
+        }
+
+        void _free_segment(_segment *s, size_type k)
+        {
+            segment_allocator_type seg_alloc(_alloc);
+            state_allocator_type state_alloc(_alloc);
+            size_type n = _segment_size(k);
+
+            state_alloc.deallocate(s->state, n);
+            _alloc.deallocate(s->data, n);
+            seg_alloc.deallocate(s, 1);
+        }
+
+        _segment *_open_segment(size_type k)
+        {
+            _segment *s = __atomic_load_n(&_segments[k], __ATOMIC_ACQUIRE);
+            if (s)
+                return s;
+
+            s = _new_segment(k);
+            _segment *installed = NULL;
+            if (__atomic_compare_exchange_n(&_segments[k], &installed, s, false,
+                                            __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+                return s;
+            _free_segment(s, k);
+            return installed;
+        }
+
+        unsigned char _state(size_type i) const
+        {
+            size_type k = _segment_of(i);
+            _segment *s = __atomic_load_n(&_segments[k], __ATOMIC_ACQUIRE);
+            if (!s)
+                return _pending;
+            return __atomic_load_n(&s->state[i - _segment_start(k)], __ATOMIC_SEQ_CST);
+        }
+
+        pointer _slot(size_type i) const
+        {
+            size_type k = _segment_of(i);
+            return __atomic_load_n(&_segments[k], __ATOMIC_ACQUIRE)->data + (i - _segment_start(k));
+        }
+
+        // Moves size() over every finished slot. Whoever finishes the slot
+        // at the current boundary carries it past the slots finished before.
+        void _advance()
+        {
+            size_type p = __atomic_load_n(&_size, __ATOMIC_ACQUIRE);
+            while (p < __atomic_load_n(&_claimed, __ATOMIC_ACQUIRE) && _state(p) != _pending)
+            {
+                if (__atomic_compare_exchange_n(&_size, &p, p + 1, false,
+                                                __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+                    ++p;
+            }
+        }
+
+    public:
+        explicit concurrent_vector(const allocator_type &alloc = allocator_type())
+            : _alloc(alloc), _claimed(0), _size(0)
+        {
+            for (size_type k = 0; k < _max_segments; ++k)
+                _segments[k] = NULL;
+        }
+
+        ~concurrent_vector()
+        {
+            clear();
+            for (size_type k = 0; k < _max_segments; ++k)
+                if (_segments[k])
+                    _free_segment(_segments[k], k);
+        }
+
+        // Capacity
+        size_type size() const { return __atomic_load_n(&_size, __ATOMIC_ACQUIRE); }
+
+        bool empty() const { return size() == 0; }
+
+        size_type max_size() const { return _alloc.max_size(); }
+
+        // Elements the opened segments can hold
+        size_type capacity() const
+        {
+            size_type k = 0;
+            while (k < _max_segments && __atomic_load_n(&_segments[k], __ATOMIC_ACQUIRE))
+                ++k;
+            return _segment_start(k);
+        }
+
+        // Opens every segment needed to hold n elements
+        void reserve(size_type n)
+        {
+            if (n > max_size())
+                throw std::length_error("concurrent_vector::reserve");
+            if (n == 0)
+                return;
+            for (size_type k = 0; k <= _segment_of(n - 1); ++k)
+                _open_segment(k);
+        }
+
+        // Element access
+        reference operator[](size_type n) { return *_slot(n); }
+        const_reference operator[](size_type n) const { return *_slot(n); }
+
+        reference at(size_type n)
+        {
+            if (n >= size() || _state(n) != _constructed)
+                throw std::out_of_range("concurrent_vector::at");
+            return *_slot(n);
+        }
+
+        const_reference at(size_type n) const
+        {
+            if (n >= size() || _state(n) != _constructed)
+                throw std::out_of_range("concurrent_vector::at");
+            return *_slot(n);
+        }
+
+        // False for an index whose element failed to construct
+        bool constructed(size_type n) const { return n < size() && _state(n) == _constructed; }
+
+        // Modifiers
+        // Returns the index the element was stored at
+        size_type push_back(const value_type &val)
+        {
+            size_type i = __atomic_fetch_add(&_claimed, 1, __ATOMIC_ACQ_REL);
+            size_type k = _segment_of(i);
+            _segment *s = _open_segment(k);
+            size_type offset = i - _segment_start(k);
+
+            try
+            {
+                _alloc.construct(s->data + offset, val);
+            }
+            catch (...)
+            {
+                __atomic_store_n(&s->state[offset], static_cast<unsigned char>(_failed), __ATOMIC_SEQ_CST);
+                _advance();
+                throw;
+            }
+            __atomic_store_n(&s->state[offset], static_cast<unsigned char>(_constructed), __ATOMIC_SEQ_CST);
+            _advance();
+            return i;
+        }
+
+        // Destroys every element but keeps the segments; not thread-safe
+        void clear()
+        {
+            for (size_type i = 0; i < _claimed; ++i)
+            {
+                size_type k = _segment_of(i);
+                _segment *s = _segments[k];
+                if (s && s->state[i - _segment_start(k)] == _constructed)
+                    _alloc.destroy(s->data + (i - _segment_start(k)));
+                if (s)
+                    s->state[i - _segment_start(k)] = _pending;
+            }
+            _claimed = 0;
+            _size = 0;
+        }
+
+        // Not thread-safe
+        void swap(concurrent_vector &x)
+        {
+            ft::swap(_alloc, x._alloc);
+            for (size_type k = 0; k < _max_segments; ++k)
+                ft::swap(_segments[k], x._segments[k]);
+            ft::swap(_claimed, x._claimed);
+            ft::swap(_size, x._size);
+        }
+
+        // Allocator
+        allocator_type get_allocator() const { return _alloc; }
+    };
+
+    template <class T, class Alloc>
+    const typename concurrent_vector<T, Alloc>::size_type concurrent_vector<T, Alloc>::first_segment;
+}
+
+#endif // CONCURRENT_VECTOR_HPP
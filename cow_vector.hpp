@@ -0,0 +1,292 @@
+#ifndef COW_VECTOR_HPP
+#define COW_VECTOR_HPP
+
+#include <memory>
+#include <new>
+#include <cstddef>
+#include "iterator.hpp"
+#include "vector.hpp"
+
+namespace ft
+{
+    // ft::vector behind a reference-counted handle. Copies share the same
+    // storage in O(1); the first mutation through a shared handle copies the
+    // elements into a private vector first. The count is atomic, so handles
+    // to one snapshot may live on different threads as long as each handle
+    // is used by one thread at a time.
+    //
+    // Non-const element access and non-const iterators hand out references
+    // that a later copy must not share, so they mark the storage unshareable:
+    // copies of it are deep until clear(), assign() or an assignment
+    // replaces the contents.
+    template <class T, class Alloc = std::allocator<T> >
+    class cow_vector
+    {
+    public:
+        typedef ft::vector<T, Alloc>                     vector_type;
+        typedef T                                        value_type;
+        typedef Alloc                                    allocator_type;
+        typedef typename vector_type::reference          reference;
+        typedef typename vector_type::const_reference    const_reference;
+        typedef typename vector_type::pointer            pointer;
+        typedef typename vector_type::const_pointer      const_pointer;
+        typedef typename vector_type::iterator           iterator;
+        typedef typename vector_type::const_iterator     const_iterator;
+        typedef typename vector_type::reverse_iterator   reverse_iterator;
+        typedef typename vector_type::const_reverse_iterator const_reverse_iterator;
+        typedef typename vector_type::difference_type    difference_type;
+        typedef typename vector_type::size_type          size_type;
+
+    private:
+        struct _rep
+        {
+            vector_type data;
+            size_type   refs;
+            bool        leaked;
+
+            // Arguments go straight to the vector's constructor
+            template <class A1>
+            explicit _rep(const A1 &a1) : data(a1), refs(1), leaked(false) {}
+
+            template <class A1, class A2, class A3>
+            _rep(const A1 &a1, const A2 &a2, const A3 &a3) : data(a1, a2, a3), refs(1), leaked(false) {}
+        };
+
+        typedef typename allocator_type::template rebind<_rep>::other rep_allocator_type;
+
+        _rep *_rep_ptr;
+
+        // Builds the vector in place inside the new _rep
+        template <class A1>
+        static _rep *_new_rep(const allocator_type &alloc, const A1 &a1)
+        {
+            rep_allocator_type rep_alloc(alloc);
+            _rep *r = rep_alloc.allocate(1);
+            try
+            {
+                new (static_cast<void*>(r)) _rep(a1);
+            }
+            catch (...)
+            {
+                rep_alloc.deallocate(r, 1);
+                throw;
+            }
+            return r;
+        }
+
+        template <class A1, class A2, class A3>
+        static _rep *_new_rep(const allocator_type &alloc, const A1 &a1, const A2 &a2, const A3 &a3)
+        {
+            rep_allocator_type rep_alloc(alloc);
+            _rep *r = rep_alloc.allocate(1);
+            try
+            {
+                new (static_cast<void*>(r)) _rep(a1, a2, a3);
+            }
+            catch (...)
+            {
+                rep_alloc.deallocate(r, 1);
+                throw;
+            }
+            return r;
+        }
+
+        static _rep *_new_rep(const vector_type &v) { return _new_rep(v.get_allocator(), v); }
+
+        static void _release(_rep *r)
+        {
+            if (__atomic_sub_fetch(&r->refs, 1, __ATOMIC_ACQ_REL) == 0)
+            {
+                rep_allocator_type rep_alloc(r->data.get_allocator());
+                r->~_rep();
+                rep_alloc.deallocate(r, 1);
+            }
+        }
+
+        static _rep *_share(_rep *r)
+        {
+            if (r->leaked)
+                return _new_rep(r->data);
+            __atomic_add_fetch(&r->refs, 1, __ATOMIC_RELAXED);
+            return r;
+        }
+
+        // Gives this handle its own copy before a mutation
+        void _detach()
+        {
+            if (__atomic_load_n(&_rep_ptr->refs, __ATOMIC_ACQUIRE) == 1)
+                return;
+            _rep *r = _new_rep(_rep_ptr->data);
+            _release(_rep_ptr);
+            _rep_ptr = r;
+        }
+
+        vector_type &_leak()
+        {
+            _detach();
+            _rep_ptr->leaked = true;
+            return _rep_ptr->data;
+        }
+
+        vector_type &_mutable()
+        {
+            _detach();
+            return _rep_ptr->data;
+        }
+
+    public:
+        // Constructors
+        explicit cow_vector(const allocator_type &alloc = allocator_type())
+            : _rep_ptr(_new_rep(alloc, alloc)) {}
+
+        explicit cow_vector(size_type n, const value_type &val = value_type(),
+                            const allocator_type &alloc = allocator_type())
+            : _rep_ptr(_new_rep(alloc, n, val, alloc)) {}
+
+        template <class InputIterator>
+        cow_vector(InputIterator first, InputIterator last,
+                   const allocator_type &alloc = allocator_type(),
+                   typename ft::enable_if<!ft::is_integral<InputIterator>::value, InputIterator>::type* = 0)
+            : _rep_ptr(_new_rep(alloc, first, last, alloc)) {}
+
+        // Deep copy of a plain vector
+        explicit cow_vector(const vector_type &v) : _rep_ptr(_new_rep(v)) {}
+
+        // O(1) unless x has handed out mutable references
+        cow_vector(const cow_vector &x) : _rep_ptr(_share(x._rep_ptr)) {}
+
+        // Destructor
+        ~cow_vector() { _release(_rep_ptr); }
+
+        // Assignment operator
+        cow_vector &operator=(const cow_vector &x)
+        {
+            if (_rep_ptr != x._rep_ptr)
+            {
+                _rep *r = _share(x._rep_ptr);
+                _release(_rep_ptr);
+                _rep_ptr = r;
+            }
+            return *this;
+        }
+
+        // Sharing
+        size_type use_count() const { return __atomic_load_n(&_rep_ptr->refs, __ATOMIC_ACQUIRE); }
+
+        bool unique() const { return use_count() == 1; }
+
+        // Read-only view of the shared storage
+        const vector_type &get() const { return _rep_ptr->data; }
+
+        // Iterators; the non-const ones detach and leak the storage
+        iterator begin() { return _leak().begin(); }
+        const_iterator begin() const { return get().begin(); }
+
+        iterator end() { return _leak().end(); }
+        const_iterator end() const { return get().end(); }
+
+        reverse_iterator rbegin() { return _leak().rbegin(); }
+        const_reverse_iterator rbegin() const { return get().rbegin(); }
+
+        reverse_iterator rend() { return _leak().rend(); }
+        const_reverse_iterator rend() const { return get().rend(); }
+
+        // Capacity
+        size_type size() const { return get().size(); }
+
+        size_type max_size() const { return get().max_size(); }
+
+        size_type capacity() const { return get().capacity(); }
+
+        bool empty() const { return get().empty(); }
+
+        void reserve(size_type n) { _mutable().reserve(n); }
+
+        void resize(size_type n, value_type val = value_type()) { _mutable().resize(n, val); }
+
+        void shrink_to_fit() { _mutable().shrink_to_fit(); }
+
+        // Element access; the non-const overloads detach and leak the storage
+        reference operator[](size_type n) { return _leak()[n]; }
+        const_reference operator[](size_type n) const { return get()[n]; }
+
+        reference at(size_type n) { return _leak().at(n); }
+        const_reference at(size_type n) const { return get().at(n); }
+
+        reference front() { return _leak().front(); }
+        const_reference front() const { return get().front(); }
+
+        reference back() { return _leak().back(); }
+        const_reference back() const { return get().back(); }
+
+        const_pointer data() const { return get().data(); }
+
+        // Writes one element without leaking the storage
+        void set(size_type n, const value_type &val) { _mutable().at(n) = val; }
+
+        // Modifiers
+        template <class InputIterator>
+        void assign(InputIterator first, InputIterator last,
+                    typename ft::enable_if<!ft::is_integral<InputIterator>::value, InputIterator>::type* = 0)
+        {
+            *this = cow_vector(first, last, get().get_allocator());
+        }
+
+        void assign(size_type n, const value_type &val)
+        {
+            *this = cow_vector(n, val, get().get_allocator());
+        }
+
+        void push_back(const value_type &val) { _mutable().push_back(val); }
+
+        void pop_back() { _mutable().pop_back(); }
+
+        // Position-based modifiers take an index, as an iterator obtained
+        // before the call may point into storage still shared with others
+        void insert(size_type pos, const value_type &val)
+        {
+            vector_type &v = _mutable();
+            v.insert(v.begin() + pos, val);
+        }
+
+        void insert(size_type pos, size_type n, const value_type &val)
+        {
+            vector_type &v = _mutable();
+            v.insert(v.begin() + pos, n, val);
+        }
+
+        void erase(size_type pos) { erase(pos, pos + 1); }
+
+        void erase(size_type first, size_type last)
+        {
+            vector_type &v = _mutable();
+            v.erase(v.begin() + first, v.begin() + last);
+        }
+
+        void clear()
+        {
+            if (unique())
+            {
+                _rep_ptr->data.clear();
+                _rep_ptr->leaked = false;
+            }
+            else
+                *this = cow_vector(get().get_allocator());
+        }
+
+        void swap(cow_vector &x) { ft::swap(_rep_ptr, x._rep_ptr); }
+
+        // Allocator
+        allocator_type get_allocator() const { return get().get_allocator(); }
+
+        // Handles sharing storage are equal without looking at the elements
+        friend bool operator==(const cow_vector &lhs, const cow_vector &rhs)
+        {
+            return lhs._rep_ptr == rhs._rep_ptr || lhs.get() == rhs.get();
+        }
+
+        friend bool operator!=(const cow_vector &lhs, const cow_vector &rhs) { return !(lhs == rhs); }
+    };
+}
+
+#endif // COW_VECTOR_HPP
@@ -10,5 +10,23 @@ namespace ft
    	 	typedef Arg2 second_argument_type;
    	 	typedef Result result_type;
   	};
+
+	// operator<, like std::less. less<> compares any two types that have
+	// an operator< between them and is transparent, so a map or set keyed
+	// by it looks up e.g. std::string keys with a const char* directly.
+	template <class T = void>
+	struct less : binary_function<T, T, bool>
+	{
+		bool operator()(const T& x, const T& y) const { return x < y; }
+	};
+
+	template <>
+	struct less<void>
+	{
+		typedef void is_transparent;
+
+		template <class T, class U>
+		bool operator()(const T& x, const U& y) const { return x < y; }
+	};
 }
 #endif 
@@ -0,0 +1,403 @@
+#ifndef INCREMENTAL_VECTOR_HPP
+#define INCREMENTAL_VECTOR_HPP
+
+#include <memory>
+#include <stdexcept>
+#include <cstddef>
+#include "iterator.hpp"
+
+namespace ft
+{
+    // Random access iterator of an incremental_vector. It stores an index, so
+    // it stays valid while elements migrate between buffers.
+    template <class Container, class Ref, class Ptr>
+    class incremental_vector_iterator
+        : public ft::iterator<ft::random_access_iterator_tag, typename Container::value_type, ptrdiff_t, Ptr, Ref>
+    {
+    public:
+        typedef Ref       reference;
+        typedef Ptr       pointer;
+        typedef ptrdiff_t difference_type;
+
+    private:
+        Container *_vec;
+        size_t    _index;
+
+        template <class, class, class> friend class incremental_vector_iterator;
+
+    public:
+        incremental_vector_iterator() : _vec(NULL), _index(0) {}
+        incremental_vector_iterator(Container *vec, size_t index) : _vec(vec), _index(index) {}
+
+        // iterator -> const_iterator
+        template <class C, class R, class P>
+        incremental_vector_iterator(const incremental_vector_iterator<C, R, P> &other)
+            : _vec(other._vec), _index(other._index) {}
+
+        reference operator*() const { return (*_vec)[_index]; }
+        pointer operator->() const { return &(*_vec)[_index]; }
+        reference operator[](difference_type n) const { return (*_vec)[_index + n]; }
+
+        incremental_vector_iterator &operator++() { ++_index; return *this; }
+        incremental_vector_iterator &operator--() { --_index; return *this; }
+
+        incremental_vector_iterator operator++(int)
+        {
+            incremental_vector_iterator tmp(*this);
+            ++_index;
+            return tmp;
+        }
+
+        incremental_vector_iterator operator--(int)
+        {
+            incremental_vector_iterator tmp(*this);
+            --_index;
+            return tmp;
+        }
+
+        incremental_vector_iterator &operator+=(difference_type n) { _index += n; return *this; }
+        incremental_vector_iterator &operator-=(difference_type n) { _index -= n; return *this; }
+
+        incremental_vector_iterator operator+(difference_type n) const { return incremental_vector_iterator(_vec, _index + n); }
+        incremental_vector_iterator operator-(difference_type n) const { return incremental_vector_iterator(_vec, _index - n); }
+
+        friend incremental_vector_iterator operator+(difference_type n, const incremental_vector_iterator &it)
+        {
+            return it + n;
+        }
+
+        template <class C, class R, class P>
+        difference_type operator-(const incremental_vector_iterator<C, R, P> &rhs) const
+        {
+            return static_cast<difference_type>(_index) - static_cast<difference_type>(rhs._index);
+        }
+
+        template <class C, class R, class P>
+        bool operator==(const incremental_vector_iterator<C, R, P> &rhs) const { return _index == rhs._index; }
+
+        template <class C, class R, class P>
+        bool operator!=(const incremental_vector_iterator<C, R, P> &rhs) const { return _index != rhs._index; }
+
+        template <class C, class R, class P>
+        bool operator<(const incremental_vector_iterator<C, R, P> &rhs) const { return _index < rhs._index; }
+
+        template <class C, class R, class P>
+        bool operator>(const incremental_vector_iterator<C, R, P> &rhs) const { return _index > rhs._index; }
+
+        template <class C, class R, class P>
+        bool operator<=(const incremental_vector_iterator<C, R, P> &rhs) const { return _index <= rhs._index; }
+
+        template <class C, class R, class P>
+        bool operator>=(const incremental_vector_iterator<C, R, P> &rhs) const { return _index >= rhs._index; }
+    };
+
+    // Vector whose growth is spread over later operations instead of paid
+    // in one reallocation. When it runs out of room it allocates the bigger
+    // buffer right away but leaves the elements where they are; every
+    // following modifier then migrates at most migration_step() of them.
+    // While both buffers are live, element i sits in the old buffer if it has
+    // not been migrated yet and in the new one otherwise, and operator[]
+    // picks the right one. Doubling leaves as many free slots as there are
+    // elements to move, so a migration always ends before the next growth.
+    //
+    // Storage is not contiguous during a migration, and element addresses
+    // change when their element migrates; iterators hold indices and stay
+    // valid.
+    template <class T, class Alloc = std::allocator<T> >
+    class incremental_vector
+    {
+    public:
+        typedef T                                        value_type;
+        typedef Alloc                                    allocator_type;
+        typedef typename allocator_type::reference       reference;
+        typedef typename allocator_type::const_reference const_reference;
+        typedef typename allocator_type::pointer         pointer;
+        typedef typename allocator_type::const_pointer   const_pointer;
+        typedef ptrdiff_t                                difference_type;
+        typedef size_t                                   size_type;
+
+        typedef incremental_vector_iterator<incremental_vector, T&, T*>                   iterator;
+        typedef incremental_vector_iterator<const incremental_vector, const T&, const T*> const_iterator;
+        typedef ft::reverse_iterator<iterator>                                            reverse_iterator;
+        typedef ft::reverse_iterator<const_iterator>                                      const_reverse_iterator;
+
+        static const size_type default_migration_step = 32;
+
+    private:
+        allocator_type _alloc;
+        pointer        _start;
+        size_type      _size;
+        size_type      _capacity;
+        pointer        _old;
+        size_type      _old_capacity;
+        size_type      _migrated;
+        size_type      _old_size;
+        size_type      _step;
+
+        // [_migrated, _old_size) still lives in _old; both are 0 when no
+        // migration is in progress
+        pointer _slot(size_type i) const { return i >= _migrated && i < _old_size ? _old + i : _start + i; }
+
+        void _end_migration_if_done()
+        {
+            if (_old && _migrated >= _old_size)
+            {
+                _alloc.deallocate(_old, _old_capacity);
+                _old = NULL;
+                _old_capacity = 0;
+                _migrated = 0;
+                _old_size = 0;
+            }
+        }
+
+        void _migrate(size_type count)
+        {
+            for (; count && _migrated < _old_size; --count)
+            {
+                _alloc.construct(_start + _migrated, _old[_migrated]);
+                _alloc.destroy(_old + _migrated);
+                ++_migrated;
+            }
+            _end_migration_if_done();
+        }
+
+        void _finish_migration() { _migrate(_old_size); }
+
+        // Switches to a buffer of n elements; the elements follow lazily
+        void _begin_growth(size_type n)
+        {
+            _finish_migration();
+
+            pointer new_start = _alloc.allocate(n);
+            if (_size == 0)
+            {
+                if (_start)
+                    _alloc.deallocate(_start, _capacity);
+            }
+            else
+            {
+                _old = _start;
+                _old_capacity = _capacity;
+                _migrated = 0;
+                _old_size = _size;
+            }
+            _start = new_start;
+            _capacity = n;
+        }
+
+        void _release()
+        {
+            clear();
+            if (_start)
+                _alloc.deallocate(_start, _capacity);
+            _start = NULL;
+            _capacity = 0;
+        }
+
+    public:
+        // Constructors
+        explicit incremental_vector(const allocator_type &alloc = allocator_type())
+            : _alloc(alloc), _start(NULL), _size(0), _capacity(0), _old(NULL), _old_capacity(0),
+              _migrated(0), _old_size(0), _step(default_migration_step) {}
+
+        explicit incremental_vector(size_type n, const value_type &val = value_type(),
+                                    const allocator_type &alloc = allocator_type())
+            : _alloc(alloc), _start(NULL), _size(0), _capacity(0), _old(NULL), _old_capacity(0),
+              _migrated(0), _old_size(0), _step(default_migration_step)
+        {
+            try
+            {
+                reserve(n);
+                while (_size < n)
+                    push_back(val);
+            }
+            catch (...)
+            {
+                _release();
+                throw;
+            }
+        }
+
+        incremental_vector(const incremental_vector &x)
+            : _alloc(x._alloc), _start(NULL), _size(0), _capacity(0), _old(NULL), _old_capacity(0),
+              _migrated(0), _old_size(0), _step(x._step)
+        {
+            try
+            {
+                reserve(x._size);
+                for (size_type i = 0; i < x._size; ++i)
+                    push_back(x[i]);
+            }
+            catch (...)
+            {
+                _release();
+                throw;
+            }
+        }
+
+        // Destructor
+        ~incremental_vector() { _release(); }
+
+        // Assignment operator
+        incremental_vector &operator=(const incremental_vector &x)
+        {
+            if (this != &x)
+            {
+                incremental_vector tmp(x);
+                swap(tmp);
+            }
+            return *this;
+        }
+
+        // Iterators
+        iterator begin() { return iterator(this, 0); }
+        const_iterator begin() const { return const_iterator(this, 0); }
+
+        iterator end() { return iterator(this, _size); }
+        const_iterator end() const { return const_iterator(this, _size); }
+
+        reverse_iterator rbegin() { return reverse_iterator(end()); }
+        const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+
+        reverse_iterator rend() { return reverse_iterator(begin()); }
+        const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+        // Capacity
+        size_type size() const { return _size; }
+
+        size_type max_size() const { return _alloc.max_size(); }
+
+        size_type capacity() const { return _capacity; }
+
+        bool empty() const { return _size == 0; }
+
+        // Grows to at least n elements; the existing ones migrate lazily
+        void reserve(size_type n)
+        {
+            if (n > max_size())
+                throw std::length_error("incremental_vector::reserve");
+            if (n > _capacity)
+                _begin_growth(n);
+        }
+
+        // Migration
+        // Elements moved per modifying call while a migration is pending
+        void set_migration_step(size_type n) { _step = n ? n : 1; }
+        size_type migration_step() const { return _step; }
+
+        bool migrating() const { return _old != NULL; }
+
+        // Moves every pending element now, e.g. ahead of a latency-critical phase
+        void finish_migration() { _finish_migration(); }
+
+        // Element access
+        reference operator[](size_type n) { return *_slot(n); }
+        const_reference operator[](size_type n) const { return *_slot(n); }
+
+        reference at(size_type n)
+        {
+            if (n >= _size)
+                throw std::out_of_range("incremental_vector::at");
+            return *_slot(n);
+        }
+
+        const_reference at(size_type n) const
+        {
+            if (n >= _size)
+                throw std::out_of_range("incremental_vector::at");
+            return *_slot(n);
+        }
+
+        reference front() { return *_slot(0); }
+        const_reference front() const { return *_slot(0); }
+
+        reference back() { return *_slot(_size - 1); }
+        const_reference back() const { return *_slot(_size - 1); }
+
+        // Modifiers
+        // val may be an element of this vector, which migrating would
+        // destroy: it is copied before anything moves, and on growth it is
+        // copied out first since _begin_growth finishes a pending migration
+        void push_back(const value_type &val)
+        {
+            if (_size == _capacity)
+            {
+                if (_capacity == max_size())
+                    throw std::length_error("incremental_vector::push_back");
+                value_type copy(val);
+                _begin_growth(_capacity > max_size() / 2 ? max_size() : (_capacity ? _capacity * 2 : 1));
+                _alloc.construct(_start + _size, copy);
+            }
+            else
+                _alloc.construct(_start + _size, val);
+            ++_size;
+
+            try
+            {
+                _migrate(_step);
+            }
+            catch (...)
+            {
+                --_size;
+                _alloc.destroy(_start + _size);
+                throw;
+            }
+        }
+
+        void pop_back()
+        {
+            if (_size == 0)
+                return;
+
+            size_type i = _size - 1;
+            _alloc.destroy(_slot(i));
+            if (i < _old_size)
+                _old_size = i;
+            --_size;
+            _end_migration_if_done();
+            _migrate(_step);
+        }
+
+        void resize(size_type n, value_type val = value_type())
+        {
+            while (_size > n)
+                pop_back();
+            if (n > _capacity)
+                reserve(n);
+            while (_size < n)
+                push_back(val);
+        }
+
+        void clear()
+        {
+            while (_size)
+            {
+                --_size;
+                _alloc.destroy(_slot(_size));
+            }
+            _old_size = 0;
+            _end_migration_if_done();
+        }
+
+        void swap(incremental_vector &x)
+        {
+            ft::swap(_alloc, x._alloc);
+            ft::swap(_start, x._start);
+            ft::swap(_size, x._size);
+            ft::swap(_capacity, x._capacity);
+            ft::swap(_old, x._old);
+            ft::swap(_old_capacity, x._old_capacity);
+            ft::swap(_migrated, x._migrated);
+            ft::swap(_old_size, x._old_size);
+            ft::swap(_step, x._step);
+        }
+
+        // Allocator
+        allocator_type get_allocator() const { return _alloc; }
+    };
+
+    template <class T, class Alloc>
+    const typename incremental_vector<T, Alloc>::size_type incremental_vector<T, Alloc>::default_migration_step;
+}
+
+#endif // INCREMENTAL_VECTOR_HPP
@@ -2,6 +2,8 @@
 #define ITERATOR_HPP
 
 #include <cstddef>
+#include <cstring>
+#include "simd.hpp"
 
 namespace ft
 {
@@ -12,6 +14,10 @@ namespace ft
     typedef std::bidirectional_iterator_tag bidirectional_iterator_tag;
     typedef std::random_access_iterator_tag random_access_iterator_tag;
 
+    // Refines random access: elements live in one array, so &*(it + n) == &*it + n.
+    // Iterators advertise it through an iterator_concept typedef.
+    struct contiguous_iterator_tag : public std::random_access_iterator_tag {};
+
     // Base iterator template
     template <class Category, class T, class Distance = ptrdiff_t,
              class Pointer = T*, class Reference = T&>
@@ -238,6 +244,79 @@ namespace ft
     template <> struct is_integral<long> : public true_type {};
     template <> struct is_integral<unsigned long> : public true_type {};
 
+    template <class T, class U> struct is_same : public false_type {};
+    template <class T> struct is_same<T, T> : public true_type {};
+
+    template <class T> struct remove_const { typedef T type; };
+    template <class T> struct remove_const<const T> { typedef T type; };
+
+    template <class Iterator>
+    struct is_contiguous_iterator
+    {
+    private:
+        typedef char yes;
+        struct no { char c[2]; };
+
+        template <class U> static yes test(typename U::iterator_concept*);
+        template <class U> static no test(...);
+
+        template <class U, bool HasConcept> struct check
+        {
+            static const bool value = is_same<typename U::iterator_concept, contiguous_iterator_tag>::value;
+        };
+        template <class U> struct check<U, false>
+        {
+            static const bool value = false;
+        };
+
+    public:
+        static const bool value = check<Iterator, sizeof(test<Iterator>(0)) == sizeof(yes)>::value;
+    };
+
+    template <class T> struct is_contiguous_iterator<T*> : public true_type {};
+    template <class T> struct is_contiguous_iterator<const T*> : public true_type {};
+
+    // True when Compare declares an is_transparent member type: it can
+    // order keys against other types, so lookups need not convert to the key
+    template <class Compare>
+    struct is_transparent
+    {
+    private:
+        typedef char yes;
+        struct no { char c[2]; };
+
+        template <class U> static yes test(typename U::is_transparent*);
+        template <class U> static no test(...);
+
+    public:
+        static const bool value = sizeof(test<Compare>(0)) == sizeof(yes);
+    };
+
+    // Return type R of a heterogeneous lookup taking a K, which only
+    // exists for transparent comparators; K keeps the test deferred to
+    // overload resolution
+    template <class Compare, class K, class R>
+    struct _if_transparent : public enable_if<is_transparent<Compare>::value, R> {};
+
+    // How equal/lexicographical_compare may treat a pair of ranges:
+    // 0 element by element, 1 raw bytes (integral values), 2 SIMD float/double kernels
+    template <class T> struct _compare_kind : public integral_constant<int, is_integral<T>::value ? 1 : 0> {};
+    template <> struct _compare_kind<float> : public integral_constant<int, 2> {};
+    template <> struct _compare_kind<double> : public integral_constant<int, 2> {};
+
+    template <class InputIterator1, class InputIterator2>
+    struct _range_compare_kind
+    {
+        typedef typename remove_const<typename iterator_traits<InputIterator1>::value_type>::type value_type1;
+        typedef typename remove_const<typename iterator_traits<InputIterator2>::value_type>::type value_type2;
+
+        static const int value = (is_contiguous_iterator<InputIterator1>::value
+                                  && is_contiguous_iterator<InputIterator2>::value
+                                  && is_same<value_type1, value_type2>::value)
+                                 ? _compare_kind<value_type1>::value : 0;
+        typedef integral_constant<int, value> type;
+    };
+
     // Iterator functions
     template <class InputIterator>
     typename iterator_traits<InputIterator>::difference_type
@@ -254,7 +333,8 @@ namespace ft
 
     // Algorithm implementations
     template <class InputIterator1, class InputIterator2>
-    bool equal(InputIterator1 first1, InputIterator1 last1, InputIterator2 first2)
+    bool _equal(InputIterator1 first1, InputIterator1 last1, InputIterator2 first2,
+                integral_constant<int, 0>)
     {
         while (first1 != last1)
         {
@@ -266,6 +346,33 @@ namespace ft
         return true;
     }
 
+    template <class InputIterator1, class InputIterator2>
+    bool _equal(InputIterator1 first1, InputIterator1 last1, InputIterator2 first2,
+                integral_constant<int, 1>)
+    {
+        size_t n = last1 - first1;
+        if (n == 0)
+            return true;
+        return std::memcmp(&*first1, &*first2, n * sizeof(*first1)) == 0;
+    }
+
+    template <class InputIterator1, class InputIterator2>
+    bool _equal(InputIterator1 first1, InputIterator1 last1, InputIterator2 first2,
+                integral_constant<int, 2>)
+    {
+        size_t n = last1 - first1;
+        if (n == 0)
+            return true;
+        return simd::mismatch(&*first1, &*first2, n) == n;
+    }
+
+    template <class InputIterator1, class InputIterator2>
+    bool equal(InputIterator1 first1, InputIterator1 last1, InputIterator2 first2)
+    {
+        return _equal(first1, last1, first2,
+                      typename _range_compare_kind<InputIterator1, InputIterator2>::type());
+    }
+
     template <class InputIterator1, class InputIterator2, class BinaryPredicate>
     bool equal(InputIterator1 first1, InputIterator1 last1,
                InputIterator2 first2, BinaryPredicate pred)
@@ -281,8 +388,9 @@ namespace ft
     }
 
     template <class InputIterator1, class InputIterator2>
-    bool lexicographical_compare(InputIterator1 first1, InputIterator1 last1,
-                                InputIterator2 first2, InputIterator2 last2)
+    bool _lexicographical_compare(InputIterator1 first1, InputIterator1 last1,
+                                  InputIterator2 first2, InputIterator2 last2,
+                                  integral_constant<int, 0>)
     {
         while (first1 != last1)
         {
@@ -296,6 +404,50 @@ namespace ft
         return (first2 != last2);
     }
 
+    template <class InputIterator1, class InputIterator2>
+    bool _lexicographical_compare(InputIterator1 first1, InputIterator1 last1,
+                                  InputIterator2 first2, InputIterator2 last2,
+                                  integral_constant<int, 1>)
+    {
+        size_t n1 = last1 - first1;
+        size_t n2 = last2 - first2;
+        size_t n = n1 < n2 ? n1 : n2;
+
+        if (n != 0)
+        {
+            size_t i = simd::mismatch_bytes(&*first1, &*first2, n * sizeof(*first1)) / sizeof(*first1);
+            if (i < n)
+                return first1[i] < first2[i];
+        }
+        return n1 < n2;
+    }
+
+    template <class InputIterator1, class InputIterator2>
+    bool _lexicographical_compare(InputIterator1 first1, InputIterator1 last1,
+                                  InputIterator2 first2, InputIterator2 last2,
+                                  integral_constant<int, 2>)
+    {
+        size_t n1 = last1 - first1;
+        size_t n2 = last2 - first2;
+        size_t n = n1 < n2 ? n1 : n2;
+
+        if (n != 0)
+        {
+            size_t i = simd::mismatch_ordered(&*first1, &*first2, n);
+            if (i < n)
+                return first1[i] < first2[i];
+        }
+        return n1 < n2;
+    }
+
+    template <class InputIterator1, class InputIterator2>
+    bool lexicographical_compare(InputIterator1 first1, InputIterator1 last1,
+                                InputIterator2 first2, InputIterator2 last2)
+    {
+        return _lexicographical_compare(first1, last1, first2, last2,
+                                        typename _range_compare_kind<InputIterator1, InputIterator2>::type());
+    }
+
     template <class InputIterator1, class InputIterator2, class Compare>
     bool lexicographical_compare(InputIterator1 first1, InputIterator1 last1,
                                 InputIterator2 first2, InputIterator2 last2,
@@ -5,32 +5,10 @@
 #include <limits>
 #include <algorithm>
 #include <cstddef>
+#include "iterator.hpp" // ft::enable_if, ft::is_integral
 
 namespace ft {
 
-// C++98 type traits for SFINAE
-template<bool B, class T = void>
-struct enable_if {};
-
-template<class T>
-struct enable_if<true, T> { typedef T type; };
-
-// is_integral type trait
-template<class T>
-struct is_integral { static const bool value = false; };
-
-template<> struct is_integral<bool> { static const bool value = true; };
-template<> struct is_integral<char> { static const bool value = true; };
-template<> struct is_integral<signed char> { static const bool value = true; };
-template<> struct is_integral<unsigned char> { static const bool value = true; };
-template<> struct is_integral<wchar_t> { static const bool value = true; };
-template<> struct is_integral<short> { static const bool value = true; };
-template<> struct is_integral<unsigned short> { static const bool value = true; };
-template<> struct is_integral<int> { static const bool value = true; };
-template<> struct is_integral<unsigned int> { static const bool value = true; };
-template<> struct is_integral<long> { static const bool value = true; };
-template<> struct is_integral<unsigned long> { static const bool value = true; };
-
 template <typename T>
 struct ListNode {
     T data;
@@ -1,9 +1,43 @@
 #include <iostream>
 #include <string>
 #include <functional> // For std::greater
+#include <cmath>
+#include <stdexcept>
+#include <sstream>
+#include <iterator>
 #include "list.hpp"
+#include "vector.hpp"
+#include "stack.hpp"
+#include "segmented_vector.hpp"
+#include "soa_vector.hpp"
+#include "compressed_int_vector.hpp"
+#include "buffer_pool.hpp"
+#include "aligned_allocator.hpp"
+#include "concurrent_vector.hpp"
+#include "incremental_vector.hpp"
+#include "cow_vector.hpp"
+#include "node_pool_allocator.hpp"
+#include "map.hpp"
+#include "set.hpp"
+#include "parallel.hpp"
     #include <list>
 
+static int g_failures = 0;
+
+// Reports a failed expectation and keeps going, so one run lists them all
+static void check(bool ok, const char* what, int line) {
+    if (!ok) {
+        std::cout << "FAILED line " << line << ": " << what << std::endl;
+        ++g_failures;
+    }
+}
+
+#define CHECK(expr) check((expr), #expr, __LINE__)
+
+static void report(const char* section) {
+    std::cout << section << ": " << (g_failures ? "failures so far" : "ok") << std::endl;
+}
+
 // Test function to check that our list implementation works correctly
 template <typename T>
 void print_list(const ft::list<T>& list, const std::string& name) {
@@ -31,6 +65,1357 @@ struct IsWithinTwo {
     }
 };
 
+// equal/lexicographical_compare on contiguous ranges take the memcmp and
+// SIMD paths; lengths around the vector widths and mismatches at every
+// position cover the kernels' heads and tails
+static void test_range_compare() {
+    for (int n = 0; n < 70; ++n) {
+        ft::vector<int> a;
+        ft::vector<double> d;
+        for (int i = 0; i < n; ++i) {
+            a.push_back(i - 20);
+            d.push_back(i * 0.5);
+        }
+        ft::vector<int> b(a);
+        ft::vector<double> e(d);
+        CHECK(ft::equal(a.begin(), a.end(), b.begin()));
+        CHECK(ft::equal(d.begin(), d.end(), e.begin()));
+        CHECK(!ft::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end()));
+        for (int i = 0; i < n; ++i) {
+            b[i] += 1;
+            e[i] += 1;
+            CHECK(!ft::equal(a.begin(), a.end(), b.begin()));
+            CHECK(!ft::equal(d.begin(), d.end(), e.begin()));
+            CHECK(ft::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end()));
+            CHECK(!ft::lexicographical_compare(b.begin(), b.end(), a.begin(), a.end()));
+            CHECK(ft::lexicographical_compare(d.begin(), d.end(), e.begin(), e.end()));
+            b[i] -= 1;
+            e[i] -= 1;
+        }
+        if (n > 0) {
+            CHECK(ft::lexicographical_compare(a.begin(), a.end() - 1, b.begin(), b.end()));
+            // Signed order, not byte order
+            b[n - 1] = -1000;
+            CHECK(ft::lexicographical_compare(b.begin(), b.end(), a.begin(), a.end()));
+        }
+    }
+
+    // Floating point compares by value: -0.0 equals 0.0, NaN equals nothing
+    ft::vector<double> z(33, 0.0), nz(33, -0.0);
+    CHECK(ft::equal(z.begin(), z.end(), nz.begin()));
+    CHECK(!ft::lexicographical_compare(z.begin(), z.end(), nz.begin(), nz.end()));
+    z[31] = std::sqrt(-1.0);
+    CHECK(!ft::equal(z.begin(), z.end(), z.begin()));
+    report("range compare");
+}
+
+// Counts live objects and copies; the copy that makes copies reach
+// throw_at throws, so a test can see which exception escaped and whether
+// anything was copied twice or leaked
+struct Tracked {
+    static long live;
+    static long copies;
+    static long throw_at;
+
+    int value;
+
+    explicit Tracked(int v = 0) : value(v) { ++live; }
+    Tracked(const Tracked& other) : value(other.value) {
+        if (++copies == throw_at)
+            throw std::runtime_error("tracked copy");
+        ++live;
+    }
+    ~Tracked() { --live; }
+
+    static void reset(long limit) {
+        copies = 0;
+        throw_at = limit;
+    }
+};
+
+long Tracked::live = 0;
+long Tracked::copies = 0;
+long Tracked::throw_at = 0;
+
+static void test_parallel_construct() {
+    const size_t n = 200000;
+    ft::vector<int> fill(n, 7, ft::parallel);
+    ft::vector<int> serial(n, 7);
+    CHECK(fill == serial);
+    ft::vector<int> copy(fill, ft::parallel);
+    CHECK(copy == fill);
+
+    // A throwing copy runs once per element at most, the original
+    // exception escapes, and nothing is left alive
+    Tracked::reset(0);
+    ft::vector<Tracked> src(n, Tracked(1));
+    long live = Tracked::live;
+    Tracked::reset(n / 2);
+    std::string what;
+    try {
+        ft::vector<Tracked> bad(src, ft::parallel);
+    } catch (const std::runtime_error& e) {
+        what = e.what();
+    }
+    CHECK(what == "tracked copy");
+    CHECK(Tracked::copies <= static_cast<long>(n));
+    CHECK(Tracked::live == live);
+    Tracked::reset(0);
+    report("parallel construction");
+}
+
+// Appending elements of the vector itself must read them before the old
+// buffer is released; strings make a stale read visible under ASan
+struct Counter {
+    int next;
+    Counter() : next(0) {}
+    std::string operator()() { return std::string(1, char('a' + next++ % 26)); }
+};
+
+// Throws on call number limit
+struct ThrowingCounter {
+    int left;
+    explicit ThrowingCounter(int limit) : left(limit) {}
+    std::string operator()() {
+        if (left-- == 0)
+            throw std::runtime_error("generator");
+        return "new";
+    }
+};
+
+static void test_append_aliasing() {
+    ft::vector<std::string> v;
+    v.push_back("first");
+    for (int i = 0; i < 10; ++i) {
+        v.shrink_to_fit();
+        v.push_back(v[0]);
+        v.push_back(v.back());
+    }
+    CHECK(v.size() == 21);
+    CHECK(v.back() == "first");
+
+    ft::vector<std::string> w;
+    w.push_back("x");
+    w.push_back("y");
+    w.shrink_to_fit();
+    w.append_range(w.begin(), w.end());
+    w.append_range(w.begin(), w.end());
+    CHECK(w.size() == 8);
+    CHECK(w[6] == "x" && w[7] == "y");
+    // In place when it fits
+    w.reserve(32);
+    w.append_range(w.begin() + 6, w.end());
+    CHECK(w.size() == 10 && w[9] == "y");
+
+    w.shrink_to_fit();
+    w.append(3, Counter());
+    CHECK(w.size() == 13 && w[10] == "a" && w[12] == "c");
+
+    ft::vector<bool> b;
+    for (int i = 0; i < 70; ++i)
+        b.push_back(i % 3 == 0);
+    ft::vector<bool> expect(b);
+    b.insert(b.begin() + 1, b.begin(), b.end());
+    ft::vector<bool> copy(expect);
+    expect.insert(expect.begin() + 1, copy.begin(), copy.end());
+    CHECK(b.size() == 140);
+    bool same = true;
+    for (size_t i = 0; i < b.size(); ++i)
+        same = same && b[i] == expect[i];
+    CHECK(same);
+
+    // Iterators that decode into themselves, and single-pass ranges
+    ft::compressed_int_vector<unsigned, 4> ids;
+    for (unsigned k = 0; k < 5; ++k)
+        ids.push_back(k * 10);
+    ft::vector<unsigned> decoded;
+    decoded.append_range(ids.begin(), ids.end());
+    CHECK(decoded.size() == 5 && decoded[3] == 30 && decoded[4] == 40);
+    std::istringstream in("1 2 3 4");
+    ft::vector<int> read;
+    read.append_range(std::istream_iterator<int>(in), std::istream_iterator<int>());
+    CHECK(read.size() == 4 && read[0] == 1 && read[3] == 4);
+    std::istringstream bits("1 0 1");
+    ft::vector<bool> read_bits;
+    read_bits.append_range(std::istream_iterator<int>(bits), std::istream_iterator<int>());
+    CHECK(read_bits.size() == 3 && read_bits[0] && !read_bits[1] && read_bits[2]);
+
+    // A throw while appending in place takes back what was built
+    ft::vector<std::string> kept;
+    kept.reserve(10);
+    kept.push_back("kept");
+    bool thrown = false;
+    try {
+        kept.append(5, ThrowingCounter(2));
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    CHECK(thrown && kept.size() == 1 && kept.back() == "kept");
+    report("append aliasing");
+}
+
+// Explicit and automatic trimming; the threshold follows the contents
+// through copies and assignment
+static void test_trim() {
+    ft::vector<int> v;
+    for (int i = 0; i < 1000; ++i)
+        v.push_back(i);
+    v.erase(v.begin() + 10, v.end());
+    CHECK(v.capacity() >= 1000);
+    v.shrink_to_fit();
+    CHECK(v.capacity() == 10 && v.size() == 10 && v[9] == 9);
+
+    v.set_trim_threshold(4);
+    for (int i = 0; i < 990; ++i)
+        v.push_back(i);
+    while (v.size() > 100)
+        v.pop_back();
+    CHECK(v.capacity() < 4 * 100 + 4);
+    CHECK(v[99] == 89);
+
+    ft::vector<int> copy(v);
+    ft::vector<int> assigned;
+    assigned = v;
+    CHECK(copy.trim_threshold() == 4);
+    CHECK(assigned.trim_threshold() == 4);
+    assigned = ft::vector<int>();
+    CHECK(assigned.trim_threshold() == 0);
+
+    ft::stack<int> st;
+    st.set_trim_threshold(4);
+    for (int i = 0; i < 1000; ++i)
+        st.push(i);
+    for (int i = 0; i < 990; ++i)
+        st.pop();
+    CHECK(st.size() == 10 && st.top() == 9);
+    st.shrink_to_fit();
+
+    // Divisors below 3 are raised to 3, so popping reallocates only
+    // geometrically often
+    ft::vector<int> tight(1000, 1);
+    tight.set_trim_threshold(2);
+    CHECK(tight.trim_threshold() == 3);
+    int reallocations = 0;
+    while (!tight.empty()) {
+        size_t before = tight.capacity();
+        tight.pop_back();
+        reallocations += tight.capacity() != before;
+    }
+    CHECK(reallocations < 40);
+    ft::vector<bool> bits;
+    bits.set_trim_threshold(1);
+    CHECK(bits.trim_threshold() == 3);
+    bits.set_trim_threshold(0);
+    CHECK(bits.trim_threshold() == 0);
+    report("trimming");
+}
+
+// Small chunks so every operation crosses chunk boundaries
+static void test_segmented_vector() {
+    typedef ft::segmented_vector<int, std::allocator<int>, 4> seg;
+    seg v;
+    v.push_back(0);
+    const int* first = &v[0];
+    for (int i = 1; i < 50; ++i)
+        v.push_back(v[i - 1] + 1);
+    CHECK(&v[0] == first);
+    CHECK(v.size() == 50 && v.back() == 49);
+
+    seg::iterator it = v.begin() + 13;
+    CHECK(*it == 13 && it[7] == 20 && *(it - 10) == 3);
+    CHECK(v.end() - v.begin() == 50 && v.end() - it == 37);
+    CHECK(it > v.begin() && it <= v.end());
+    int sum = 0;
+    const seg& cv = v;
+    for (seg::const_reverse_iterator r = cv.rbegin(); r != cv.rend(); ++r)
+        sum += *r;
+    CHECK(sum == 49 * 50 / 2);
+
+    seg copy(v);
+    CHECK(copy.size() == 50 && copy[37] == 37 && &copy[0] != first);
+    v.resize(6);
+    CHECK(v.size() == 6 && &v[0] == first);
+    v.resize(9, -1);
+    CHECK(v[5] == 5 && v[8] == -1);
+    while (!v.empty())
+        v.pop_back();
+    v.shrink_to_fit();
+    CHECK(v.capacity() == 0);
+    bool thrown = false;
+    try {
+        v.at(0);
+    } catch (const std::out_of_range&) {
+        thrown = true;
+    }
+    CHECK(thrown);
+    report("segmented vector");
+}
+
+// Columns stay the same length through every modifier, including a
+// push_back that throws halfway through the row
+static void test_soa_vector() {
+    typedef ft::soa_vector<int, double, std::string> rows;
+    rows r;
+    for (int i = 0; i < 20; ++i)
+        r.push_back(i, i * 0.5, std::string(1, char('a' + i)));
+    CHECK(r.size() == 20);
+    CHECK(r.get<0>(7) == 7 && r.get<1>(7) == 3.5 && r.get<2>(7) == "h");
+
+    long sum = 0;
+    for (ft::vector<int>::const_iterator it = r.column<0>().begin(); it != r.column<0>().end(); ++it)
+        sum += *it;
+    CHECK(sum == 190);
+    for (ft::vector<double>::iterator it = r.begin<1>(); it != r.end<1>(); ++it)
+        *it *= 2;
+    CHECK(r.get<1>(19) == 19.0);
+
+    r.erase(2, 5);
+    r.erase(0);
+    CHECK(r.size() == 16 && r.get<0>(0) == 1 && r.get<2>(1) == "f");
+    r.resize(18);
+    CHECK(r.column<2>().size() == 18 && r.get<2>(17).empty());
+    r.pop_back();
+    CHECK(r.column<1>().size() == 17);
+
+    rows other;
+    other.swap(r);
+    CHECK(r.empty() && other.size() == 17);
+
+    ft::soa_vector<int, Tracked> t;
+    t.push_back(1, Tracked(1));
+    Tracked::reset(1);
+    bool thrown = false;
+    try {
+        t.push_back(2, Tracked(2));
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    Tracked::reset(0);
+    CHECK(thrown);
+    CHECK(t.size() == 1 && t.column<1>().size() == 1);
+    report("soa vector");
+}
+
+// The bool specialization offers the same interface as the primary
+// template: appends, trimming, parallel constructors, stack<bool> and
+// soa_vector columns
+struct Alternating {
+    int n;
+    Alternating() : n(0) {}
+    bool operator()() { return n++ % 2 == 0; }
+};
+
+static void test_vector_bool() {
+    ft::vector<bool> b(130, false);
+    b[0] = true;
+    b[64] = true;
+    b[129] = true;
+    CHECK(b.find_first() == 0);
+    CHECK(b.find_next(0) == 64);
+    CHECK(b.find_next(64) == 129);
+    CHECK(b.find_next(128) == 129);
+    CHECK(b.find_next(129) == ft::vector<bool>::npos);
+    CHECK(b.find_next(ft::vector<bool>::npos) == ft::vector<bool>::npos);
+    CHECK(ft::vector<bool>().find_next(0) == ft::vector<bool>::npos);
+    CHECK(b.count() == 3);
+
+    b.append(5, Alternating());
+    CHECK(b.size() == 135 && b[130] && !b[131] && b[134]);
+    b.append_range(b.begin(), b.begin() + 2);
+    CHECK(b.size() == 137 && b[135] && !b[136]);
+
+    ft::vector<bool> fill(1000, true, ft::parallel);
+    ft::vector<bool> copy(fill, ft::parallel);
+    CHECK(copy.size() == 1000 && copy.count() == 1000);
+
+    copy.set_trim_threshold(4);
+    copy.erase(copy.begin() + 10, copy.end());
+    CHECK(copy.capacity() < 1000 && copy.count() == 10);
+    ft::vector<bool> assigned;
+    assigned = copy;
+    CHECK(assigned.trim_threshold() == 4);
+
+    ft::stack<bool> st;
+    st.set_trim_threshold(4);
+    for (int i = 0; i < 300; ++i)
+        st.push(i % 3 == 0);
+    while (st.size() > 1)
+        st.pop();
+    CHECK(st.top());
+
+    ft::soa_vector<int, bool> flags;
+    flags.push_back(1, false);
+    flags.push_back(2, true);
+    flags.get<1>(0) = true;
+    CHECK(flags.get<1>(0) && flags.column<1>().count() == 2);
+    const ft::soa_vector<int, bool>& cflags = flags;
+    CHECK(cflags.get<1>(1));
+    report("vector<bool>");
+}
+
+// Deltas of every width, including the full word, through element access,
+// lower_bound and bulk decode; blocks of 8 keep several blocks and a tail
+static void test_compressed_int_vector() {
+    typedef ft::compressed_int_vector<unsigned long, 8> ids;
+    ft::vector<unsigned long> plain;
+    ids c;
+    unsigned long value = 0;
+    for (int i = 0; i < 70; ++i) {
+        value += (i % 9 == 0) ? (1UL << (i % 64)) : i % 5;
+        plain.push_back(value);
+        c.push_back(value);
+    }
+    c.push_back(~0UL);
+    plain.push_back(~0UL);
+    CHECK(c.size() == 71 && c.block_count() == 8);
+
+    bool same = true;
+    size_t i = 0;
+    for (ids::const_iterator it = c.begin(); it != c.end(); ++it, ++i)
+        same = same && *it == plain[i] && c[i] == plain[i];
+    CHECK(same && i == plain.size());
+
+    // A dereferenced value outlives the step past it
+    ids::const_iterator it = c.begin();
+    ft::iterator_traits<ids::const_iterator>::reference first = *it;
+    ++it;
+    CHECK(first == plain[0] && *it == plain[1]);
+
+    ft::vector<unsigned long> out(c.size());
+    CHECK(c.decode(&out[0]) == c.size());
+    CHECK(out == plain);
+    CHECK(c.lower_bound(plain[40]).index() <= 40 && *c.lower_bound(plain[40]) == plain[40]);
+    CHECK(c.contains(~0UL) && !c.contains(plain[70] - 1));
+
+    bool thrown = false;
+    try {
+        c.push_back(5);
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    CHECK(thrown && c.size() == 71);
+
+    ft::compressed_int_vector<unsigned char, 4> small;
+    for (int k = 0; k < 256; k += 3)
+        small.push_back(static_cast<unsigned char>(k));
+    CHECK(small[85] == 255 && small.back() == 255);
+    report("compressed int vector");
+}
+
+typedef ft::vector<int, ft::buffer_pool_allocator<int> > pooled_vector;
+
+static void* pooled_worker(void* arg) {
+    pooled_vector v(1000, 1);
+    v.clear();
+    v.shrink_to_fit();
+    *static_cast<size_t*>(arg) = ft::buffer_pool::cached_bytes();
+    return NULL;
+}
+
+// A freed buffer comes back for the next request of its size class, each
+// thread has its own cache, and trim empties the caller's
+static void test_buffer_pool() {
+    ft::buffer_pool::trim();
+    const int* first;
+    {
+        pooled_vector v(1000, 1);
+        first = &v[0];
+    }
+    CHECK(ft::buffer_pool::cached_bytes() == 4096);
+    {
+        pooled_vector v;
+        v.reserve(900);
+        CHECK(v.data() == first);
+        CHECK(ft::buffer_pool::cached_bytes() == 0);
+        v.push_back(3);
+        v.resize(900, 2);
+        CHECK(v[0] == 3 && v[899] == 2 && v.data() == first);
+    }
+
+    size_t worker_cached = 0;
+    pthread_t thread;
+    CHECK(pthread_create(&thread, NULL, &pooled_worker, &worker_cached) == 0);
+    pthread_join(thread, NULL);
+    CHECK(worker_cached == 4096);
+    CHECK(ft::buffer_pool::cached_bytes() == 4096);
+
+    // Past max_cached per class the buffers go back to operator delete
+    {
+        pooled_vector many[ft::buffer_pool::max_cached + 2];
+        for (size_t i = 0; i < ft::buffer_pool::max_cached + 2; ++i)
+            many[i].reserve(100);
+    }
+    CHECK(ft::buffer_pool::cached_bytes() <= 4096 + ft::buffer_pool::max_cached * 512);
+    ft::buffer_pool::trim();
+    CHECK(ft::buffer_pool::cached_bytes() == 0);
+    report("buffer pool");
+}
+
+template <class Vector>
+static bool starts_aligned(const Vector& v) {
+    return reinterpret_cast<size_t>(v.data()) % Vector::alignment() == 0;
+}
+
+// Every buffer the vector holds, after growth, shrinking and copying,
+// starts on the promised boundary
+static void test_aligned_allocator() {
+    typedef ft::vector<float, ft::aligned_allocator<float> > lines;
+    typedef ft::vector<double, ft::aligned_allocator<double, 256> > pages;
+    CHECK(lines::alignment() == 64);
+    CHECK(pages::alignment() == 256);
+    CHECK(ft::vector<int>::alignment() == __alignof__(int));
+
+    lines v;
+    bool aligned = true;
+    for (int i = 0; i < 1000; ++i) {
+        v.push_back(i * 0.5f);
+        aligned = aligned && starts_aligned(v);
+    }
+    CHECK(aligned);
+    v.erase(v.begin() + 3, v.end());
+    v.shrink_to_fit();
+    CHECK(starts_aligned(v) && v.size() == 3 && v[2] == 1.0f);
+    lines copy(v);
+    CHECK(starts_aligned(copy) && copy == v);
+
+    pages p(7, 1.5);
+    CHECK(starts_aligned(p));
+    p.reserve(1 << 12);
+    CHECK(starts_aligned(p) && p[6] == 1.5);
+    report("aligned allocator");
+}
+
+struct PushJob {
+    ft::concurrent_vector<long>* v;
+    long base;
+    int count;
+    bool ok;
+};
+
+// Each worker reads back its own element right away and checks that the
+// published prefix never shows an unfinished slot
+static void* push_worker(void* arg) {
+    PushJob* job = static_cast<PushJob*>(arg);
+    job->ok = true;
+    for (int i = 0; i < job->count; ++i) {
+        size_t index = job->v->push_back(job->base + i);
+        if ((*job->v)[index] != job->base + i)
+            job->ok = false;
+        size_t published = job->v->size();
+        if (published && !job->v->constructed(published - 1))
+            job->ok = false;
+    }
+    return NULL;
+}
+
+static void test_concurrent_vector() {
+    const int threads = 4;
+    const int per_thread = 20000;
+    ft::concurrent_vector<long> v;
+    const long* first = NULL;
+    v.push_back(-1);
+    first = &v[0];
+
+    PushJob jobs[threads];
+    pthread_t ids[threads];
+    for (int t = 0; t < threads; ++t) {
+        jobs[t].v = &v;
+        jobs[t].base = t * 1000000L;
+        jobs[t].count = per_thread;
+        CHECK(pthread_create(&ids[t], NULL, &push_worker, &jobs[t]) == 0);
+    }
+    for (int t = 0; t < threads; ++t) {
+        pthread_join(ids[t], NULL);
+        CHECK(jobs[t].ok);
+    }
+
+    CHECK(v.size() == size_t(threads * per_thread + 1));
+    CHECK(&v[0] == first);
+    // Every value once, each thread's values in the order it pushed them
+    long next[threads] = {0, 0, 0, 0};
+    bool ordered = true;
+    for (size_t i = 1; i < v.size(); ++i) {
+        int t = static_cast<int>(v[i] / 1000000L);
+        ordered = ordered && t < threads && v[i] % 1000000L == next[t];
+        if (t < threads)
+            ++next[t];
+    }
+    CHECK(ordered);
+    for (int t = 0; t < threads; ++t)
+        CHECK(next[t] == per_thread);
+
+    // A throwing copy leaves a hole that at() refuses
+    ft::concurrent_vector<Tracked> holes;
+    holes.push_back(Tracked(1));
+    Tracked::reset(1);
+    bool thrown = false;
+    try {
+        holes.push_back(Tracked(2));
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    Tracked::reset(0);
+    holes.push_back(Tracked(3));
+    CHECK(thrown && holes.size() == 3);
+    CHECK(holes.constructed(0) && !holes.constructed(1) && holes.constructed(2));
+    thrown = false;
+    try {
+        holes.at(1);
+    } catch (const std::out_of_range&) {
+        thrown = true;
+    }
+    CHECK(thrown && holes[2].value == 3);
+    report("concurrent vector");
+}
+
+// Pushing an element of the vector itself while it migrates, and at the
+// push that starts the next growth; strings expose stale reads under ASan
+static void test_incremental_vector() {
+    ft::incremental_vector<std::string> v;
+    v.set_migration_step(1);
+    for (int i = 0; i < 17; ++i)
+        v.push_back(std::string(20, char('a' + i)));
+    CHECK(v.migrating());
+
+    bool checked_mid = false;
+    while (v.migrating()) {
+        v.push_back(v[0]);
+        v.push_back(v.back());
+        v.push_back(v[v.size() / 3]);
+        checked_mid = true;
+    }
+    CHECK(checked_mid);
+    for (int i = 0; i < 64; ++i)
+        v.push_back(v[i]);
+    CHECK(v[0] == std::string(20, 'a') && v[16] == std::string(20, 'q'));
+    CHECK(v.back() == v[63]);
+
+    size_t n = v.size();
+    v.resize(n + 40, v[1]);
+    CHECK(v.size() == n + 40 && v.back() == v[1]);
+
+    ft::incremental_vector<int> w;
+    for (int i = 0; i < 1000; ++i)
+        w.push_back(i);
+    w.finish_migration();
+    bool same = true;
+    for (int i = 0; i < 1000; ++i)
+        same = same && w[i] == i;
+    CHECK(same && !w.migrating());
+    while (w.size() > 3)
+        w.pop_back();
+    CHECK(w.back() == 2);
+    report("incremental vector");
+}
+
+// Each element is copied once on construction and once on the first
+// write through a shared handle, and never for a plain copy
+static void test_cow_vector() {
+    const long n = 100;
+    Tracked::reset(0);
+    ft::cow_vector<Tracked> a(n, Tracked(1));
+    CHECK(Tracked::copies == n);
+
+    ft::vector<Tracked> plain(n, Tracked(2));
+    Tracked::reset(0);
+    ft::cow_vector<Tracked> from_range(plain.begin(), plain.end());
+    CHECK(Tracked::copies == n);
+
+    Tracked::reset(0);
+    ft::cow_vector<Tracked> b(a);
+    ft::cow_vector<Tracked> c;
+    c = a;
+    CHECK(Tracked::copies == 0 && a.use_count() == 3);
+
+    b.set(0, Tracked(5));
+    CHECK(Tracked::copies == n);
+    CHECK(a.use_count() == 2 && b.unique());
+    CHECK(a[0].value == 1 && b.get()[0].value == 5);
+
+    // a handed out a mutable reference, so copying it is deep
+    Tracked::reset(0);
+    ft::cow_vector<Tracked> d(a);
+    CHECK(Tracked::copies == n && d.unique());
+    a[1].value = 9;
+    CHECK(d.get()[1].value == 1);
+
+    c.push_back(Tracked(3));
+    c.erase(0, 10);
+    c.insert(0, 2, Tracked(4));
+    CHECK(c.size() == size_t(n - 10 + 3) && c.get()[1].value == 4 && c.get().back().value == 3);
+    c.clear();
+    CHECK(c.empty());
+    Tracked::reset(0);
+    report("cow vector");
+}
+
+typedef ft::map<int, int, std::less<int>, ft::node_pool_allocator<ft::pair<const int, int> > > pooled_map;
+
+// Churn through the pool, then move elements between pooled maps: copies
+// and separately built maps have pools of their own, so merge and join
+// copy the nodes over, and split hands its output the source's pool
+static void test_node_pool_allocator() {
+    pooled_map m;
+    for (int round = 0; round < 5; ++round) {
+        for (int i = 0; i < 500; ++i)
+            m.insert(ft::make_pair(i, i + round));
+        for (int i = 0; i < 500; i += 2)
+            m.erase(i);
+        CHECK(m.size() == 250 && m[1] == 1 + round);
+        m.clear();
+    }
+    for (int i = 0; i < 100; ++i)
+        m[i] = i;
+
+    pooled_map copy(m);
+    CHECK(copy.size() == 100 && !(copy.get_allocator() == m.get_allocator()));
+    copy[5] = -5;
+    CHECK(m[5] == 5);
+
+    pooled_map high;
+    for (int i = 100; i < 150; ++i)
+        high[i] = i;
+    m.join(high);
+    CHECK(m.size() == 150 && high.empty() && m[149] == 149);
+
+    pooled_map other;
+    other[50] = -1;
+    other[200] = 200;
+    m.merge(other);
+    CHECK(m.size() == 151 && m[50] == 50 && m[200] == 200);
+    CHECK(other.size() == 1 && other[50] == -1);
+
+    pooled_map upper;
+    m.split(75, upper);
+    CHECK(m.size() == 75 && upper.size() == 76);
+    CHECK(upper.begin()->first == 75 && (--m.end())->first == 74);
+    upper.erase(75);
+    m.join(upper);
+    CHECK(m.size() == 150 && upper.empty());
+    report("node pool allocator");
+}
+
+// Comparator that counts its calls, to tell O(1) work from a descent
+struct CountingLess {
+    static long calls;
+    bool operator()(int a, int b) const {
+        ++calls;
+        return a < b;
+    }
+};
+
+long CountingLess::calls = 0;
+
+typedef ft::rb_tree<int, int, ft::Identity<int>, CountingLess, std::allocator<int> > plain_tree;
+typedef ft::rb_tree<int, int, ft::Identity<int>, CountingLess, std::allocator<int>, true> ranked_tree;
+
+// Inserting right before or after the hint costs a few comparisons no
+// matter the size; a wrong hint still puts the value in its place
+template <class Tree>
+static void check_hinted_insert() {
+    const int n = 4096;
+    Tree t;
+    CountingLess::calls = 0;
+    for (int i = 0; i < n; i += 2)
+        t.insert(t.end(), i);
+    CHECK(CountingLess::calls <= 4L * n / 2);
+    CHECK(t.verify() && t.size() == size_t(n / 2));
+
+    // Each odd key goes right before the hint
+    CountingLess::calls = 0;
+    typename Tree::iterator hint = t.begin();
+    for (int i = 1; i < n; i += 2) {
+        ++hint;
+        hint = ++t.insert(hint, i);
+        --hint;
+    }
+    CHECK(CountingLess::calls <= 6L * n / 2);
+    CHECK(t.verify() && t.size() == size_t(n));
+
+    CountingLess::calls = 0;
+    for (int i = -1; i > -200; --i)
+        t.insert(t.begin(), i);
+    CHECK(CountingLess::calls <= 4L * 199);
+
+    // Wrong hints and duplicates
+    t.insert(t.begin(), n + 10);
+    t.insert(t.end(), -500);
+    typename Tree::iterator dup = t.insert(t.begin(), 7);
+    CHECK(*dup == 7 && t.size() == size_t(n + 201));
+    CHECK(t.verify() && *t.begin() == -500 && *--t.end() == n + 10);
+
+    for (int i = 0; i < 3; ++i) {
+        t.insert_multi(t.find(100), 100);
+        t.insert_multi(t.end(), 100);
+        t.insert_multi(t.begin(), 100);
+    }
+    CHECK(t.count_multi(100) == 10 && t.verify());
+}
+
+static void test_hinted_insert() {
+    check_hinted_insert<plain_tree>();
+    check_hinted_insert<ranked_tree>();
+    report("hinted insert");
+}
+
+// Sorted input of every size up to a few full levels builds a valid tree
+// with a few comparisons per element; anything else falls back to
+// inserting, with duplicates handled per container
+static void test_sorted_construction() {
+    bool valid = true;
+    bool cheap = true;
+    for (int n = 0; n < 70; ++n) {
+        ft::vector<int> keys;
+        for (int i = 0; i < n; ++i)
+            keys.push_back(i * 3);
+        plain_tree t;
+        CountingLess::calls = 0;
+        t.insert_range(keys.begin(), keys.end());
+        cheap = cheap && CountingLess::calls <= 3L * n;
+        valid = valid && t.verify() && t.size() == size_t(n);
+        ranked_tree r;
+        r.assign_sorted(keys.begin(), keys.end(), true);
+        valid = valid && r.verify() && r.size() == size_t(n);
+        if (n)
+            valid = valid && *r.nth(n / 2) == keys[n / 2];
+    }
+    CHECK(valid);
+    CHECK(cheap);
+
+    ft::vector<int> mixed;
+    for (int i = 0; i < 50; ++i)
+        mixed.push_back((i * 37) % 20);
+    plain_tree unsorted;
+    unsorted.insert_range(mixed.begin(), mixed.end());
+    CHECK(unsorted.verify() && unsorted.size() == 20);
+    plain_tree multi;
+    multi.insert_range_multi(mixed.begin(), mixed.end());
+    CHECK(multi.verify() && multi.size() == 50);
+
+    ft::vector<ft::pair<int, int> > pairs;
+    for (int i = 0; i < 100; ++i)
+        pairs.push_back(ft::make_pair(i / 2, i));
+    ft::map<int, int> m(pairs.begin(), pairs.end());
+    CHECK(m.size() == 50 && m[10] == 20);
+    ft::multimap<int, int> mm(pairs.begin(), pairs.end());
+    CHECK(mm.size() == 100 && mm.count(10) == 2);
+    ft::set<int> tagged(ft::sorted_range, mixed.begin(), mixed.begin());
+    CHECK(tagged.empty());
+    ft::vector<int> keys(10, 0);
+    for (int i = 0; i < 10; ++i)
+        keys[i] = i;
+    ft::set<int> fast(ft::sorted_range, keys.begin(), keys.end());
+    CHECK(fast.size() == 10 && *fast.begin() == 0 && *--fast.end() == 9);
+    report("sorted construction");
+}
+
+// Lookup-or-insert costs one descent: on a balanced tree of 1024 keys
+// that is about 11 comparisons per call, where a find followed by an
+// insert would need twice as many
+static void test_single_descent() {
+    ft::vector<ft::pair<int, int> > pairs;
+    ft::vector<int> keys;
+    for (int i = 0; i < 1024; ++i) {
+        pairs.push_back(ft::make_pair(i * 2, i));
+        keys.push_back(i * 2);
+    }
+    ft::map<int, int, CountingLess> m(ft::sorted_range, pairs.begin(), pairs.end());
+    ft::set<int, CountingLess> st(ft::sorted_range, keys.begin(), keys.end());
+
+    CountingLess::calls = 0;
+    long sum = 0;
+    for (int i = 0; i < 1024; ++i)
+        sum += m[i * 2];
+    CHECK(sum == 1023L * 1024 / 2);
+    CHECK(CountingLess::calls <= 13L * 1024);
+
+    CountingLess::calls = 0;
+    bool none_inserted = true;
+    for (int i = 0; i < 1024; ++i) {
+        none_inserted = none_inserted && !m.insert(ft::make_pair(i * 2, -1)).second;
+        none_inserted = none_inserted && !st.insert(i * 2).second;
+    }
+    CHECK(none_inserted && m[2] == 1);
+    CHECK(CountingLess::calls <= 2 * 13L * 1024);
+
+    CountingLess::calls = 0;
+    for (int i = 0; i < 1024; ++i) {
+        m[i * 2 + 1] = -i;
+        st.insert(i * 2 + 1);
+    }
+    CHECK(m.size() == 2048 && st.size() == 2048 && m[7] == -3);
+    CHECK(CountingLess::calls <= 2 * 14L * 1024);
+    report("single descent");
+}
+
+// begin() and --end() come from cached extremes; verify() compares them
+// with a walk after every kind of change
+static void test_cached_extremes() {
+    plain_tree t;
+    CHECK(t.begin() == t.end() && t.verify());
+    bool ok = true;
+    for (int i = 0; i < 300; ++i) {
+        int key = (i % 2) ? 1000 + i : -i;
+        t.insert(key);
+        ok = ok && *t.begin() == -(i - (i % 2)) && t.verify();
+    }
+    CHECK(ok);
+    CHECK(*--t.end() == 1299 && *t.rbegin() == 1299);
+
+    // Pop-min and pop-max loops
+    ok = true;
+    for (int i = 0; i < 100; ++i) {
+        t.erase(t.begin());
+        t.erase(--t.end());
+        ok = ok && t.verify();
+    }
+    CHECK(ok && t.size() == 100 && *t.begin() == -98 && *--t.end() == 1099);
+
+    plain_tree copy(t);
+    plain_tree assigned;
+    assigned = t;
+    CHECK(copy.verify() && assigned.verify() && *--assigned.end() == 1099);
+    plain_tree other;
+    other.insert(5);
+    other.swap(copy);
+    CHECK(other.verify() && copy.verify() && *copy.begin() == 5 && *other.begin() == -98);
+    t.erase(t.begin(), t.find(1001));
+    CHECK(t.verify() && *t.begin() == 1001);
+    t.clear();
+    CHECK(t.begin() == t.end() && t.verify());
+    t.insert(1);
+    CHECK(*t.begin() == 1 && *--t.end() == 1 && t.verify());
+    report("cached extremes");
+}
+
+// Three links and the value, nothing else; color and sentinel flags ride
+// in the parent link without disturbing it
+static void test_node_layout() {
+    typedef ft::rb_tree_node<int> int_node;
+    typedef ft::rb_tree_node<ft::pair<const int, int> > pair_node;
+    typedef ft::rb_tree_node<int, true> ranked_node;
+    typedef ft::rb_tree_node<char> char_node;
+    CHECK(sizeof(int_node) <= 4 * sizeof(void*));
+    CHECK(sizeof(pair_node) <= 4 * sizeof(void*));
+    CHECK(sizeof(char_node) <= 4 * sizeof(void*));
+    CHECK(sizeof(ranked_node) <= 5 * sizeof(void*));
+
+    int_node a(1), b(2);
+    a.reset(&b, ft::RED);
+    CHECK(a.parent() == &b && a.color() == ft::RED && !a.is_header());
+    a.set_color(ft::BLACK);
+    CHECK(a.parent() == &b && a.color() == ft::BLACK);
+    a.set_parent(NULL);
+    a.set_color(ft::RED);
+    CHECK(a.parent() == NULL && a.color() == ft::RED);
+    a.make_header();
+    a.set_parent(&b);
+    CHECK(a.is_header() && a.color() == ft::RED && a.parent() == &b);
+    CHECK(int_node::leaf()->is_header() && int_node::leaf()->color() == ft::BLACK);
+
+    // Values that need more alignment than a pointer keep it
+    ft::set<long double> wide;
+    for (int i = 0; i < 100; ++i)
+        wide.insert(i * 0.25L);
+    CHECK(wide.size() == 100 && *--wide.end() == 24.75L);
+    report("node layout");
+}
+
+// Iterators are a bare node pointer, walk both ways on their own, and keep
+// pointing at their element when it changes trees
+static void test_slim_iterators() {
+    CHECK(sizeof(plain_tree::iterator) == sizeof(void*));
+    CHECK(sizeof(plain_tree::const_iterator) == sizeof(void*));
+    CHECK(sizeof(ft::map<int, int>::iterator) == sizeof(void*));
+
+    plain_tree t;
+    for (int i = 0; i < 200; ++i)
+        t.insert((i * 73) % 200);
+    int expect = 0;
+    bool ok = true;
+    for (plain_tree::iterator it = t.begin(); it != t.end(); ++it)
+        ok = ok && *it == expect++;
+    for (plain_tree::iterator it = t.end(); it != t.begin(); )
+        ok = ok && *--it == --expect;
+    CHECK(ok && expect == 0);
+
+    plain_tree::iterator last = --t.end();
+    plain_tree::iterator past = last;
+    CHECK(++past == t.end() && --past == last);
+    plain_tree::const_iterator c = t.begin();
+    CHECK(c == t.begin() && c != last);
+
+    plain_tree::iterator kept = t.find(150);
+    plain_tree::iterator low = t.find(10);
+    plain_tree other;
+    t.split(100, other);
+    CHECK(*kept == 150 && *--kept == 149 && *++kept == 150);
+    plain_tree::iterator after = kept;
+    while (++after != other.end() && *after < 160)
+        ;
+    CHECK(after != other.end() && *after == 160);
+    t.swap(other);
+    CHECK(*low == 10 && *--other.end() == 99 && *t.begin() == 100);
+    report("slim iterators");
+}
+
+// Ranked and plain containers agree on every query; the ranked one
+// counts 1000 duplicates with O(log n) comparisons
+template <class Multimap>
+static bool order_queries_match(const Multimap& mm, const ft::vector<int>& sorted) {
+    bool ok = true;
+    size_t i = 0;
+    for (typename Multimap::const_iterator it = mm.begin(); it != mm.end(); ++it, ++i)
+        ok = ok && mm.nth(i)->first == sorted[i] && mm.index_of(it) == i;
+    ok = ok && mm.nth(sorted.size()) == mm.end() && mm.index_of(mm.end()) == mm.size();
+    for (int k = -1; k <= 51; ++k) {
+        size_t below = 0;
+        while (below < sorted.size() && sorted[below] < k)
+            ++below;
+        ok = ok && mm.rank(k) == below;
+        ok = ok && mm.count_range(k, k + 3) == mm.rank(k + 3) - below;
+    }
+    return ok && mm.count_range(10, 5) == 0;
+}
+
+static void test_order_statistics() {
+    typedef std::allocator<ft::pair<const int, int> > pair_alloc;
+    ft::multimap<int, int, CountingLess, pair_alloc, true> ranked;
+    ft::multimap<int, int, CountingLess> plain;
+    ft::vector<int> sorted;
+    for (int i = 0; i < 1000; ++i) {
+        ranked.insert(ft::make_pair((i * 7) % 50, i));
+        plain.insert(ft::make_pair((i * 7) % 50, i));
+    }
+    for (int k = 0; k < 50; ++k)
+        for (int j = 0; j < 20; ++j)
+            sorted.push_back(k);
+    CHECK(order_queries_match(ranked, sorted));
+    CHECK(order_queries_match(plain, sorted));
+
+    ft::multimap<int, int, CountingLess, pair_alloc, true> same;
+    for (int i = 0; i < 1000; ++i)
+        same.insert(same.end(), ft::make_pair(7, i));
+    CountingLess::calls = 0;
+    CHECK(same.count(7) == 1000);
+    CHECK(CountingLess::calls <= 4 * 20);
+    CHECK(same.nth(500)->second == 500);
+
+    // Sizes survive rotations from erases and inserts in the middle
+    ranked_tree r;
+    for (int i = 0; i < 500; ++i)
+        r.insert_multi(i % 100);
+    bool valid = true;
+    for (int i = 0; i < 250; ++i) {
+        r.erase(r.nth((i * 13) % r.size()));
+        valid = valid && r.verify();
+    }
+    CHECK(valid && r.size() == 250);
+    report("order statistics");
+}
+
+// Splits at the start, middle and end (and past both ends) of trees of
+// every shape up to a few levels, then joins the parts back; both parts
+// and the result must pass verify()
+template <class Tree>
+static bool split_join_round_trip(int n, int at) {
+    Tree t;
+    for (int i = 0; i < n; ++i)
+        t.insert_multi(i / 2);
+    Tree right;
+    t.split(at, right);
+    bool ok = t.verify() && right.verify();
+    ok = ok && t.size() == size_t(at <= 0 ? 0 : (at * 2 < n ? at * 2 : n));
+    ok = ok && t.size() + right.size() == size_t(n);
+    ok = ok && (t.size() == 0 || *--t.end() < at);
+    ok = ok && (right.size() == 0 || *right.begin() >= at);
+    t.join_multi(right);
+    ok = ok && t.verify() && right.verify() && right.empty() && t.size() == size_t(n);
+    return ok;
+}
+
+static void test_split_join() {
+    bool ok = true;
+    for (int n = 0; n < 40; ++n) {
+        int cuts[] = { -1, 0, n / 4, n / 2, n / 2 + 1, (n + 1) / 2, n };
+        for (size_t c = 0; c < sizeof(cuts) / sizeof(cuts[0]); ++c) {
+            ok = ok && split_join_round_trip<plain_tree>(n, cuts[c]);
+            ok = ok && split_join_round_trip<ranked_tree>(n, cuts[c]);
+        }
+    }
+    CHECK(ok);
+
+    // Joining trees of very different heights, in both directions
+    plain_tree small;
+    plain_tree big;
+    for (int i = 0; i < 1000; ++i)
+        big.insert(i);
+    small.insert(-1);
+    small.join(big);
+    CHECK(small.verify() && small.size() == 1001 && big.verify() && big.empty());
+    big.insert(5000);
+    small.join(big);
+    CHECK(small.verify() && *--small.end() == 5000);
+
+    plain_tree overlap;
+    overlap.insert(500);
+    bool thrown = false;
+    try {
+        small.join(overlap);
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    CHECK(thrown && overlap.size() == 1 && small.size() == 1002);
+
+    ft::set<int> st;
+    for (int i = 0; i < 100; ++i)
+        st.insert(i);
+    ft::set<int> upper;
+    st.split(50, upper);
+    CHECK(st.size() == 50 && upper.size() == 50 && *upper.begin() == 50);
+    st.split(0, upper);
+    CHECK(st.empty() && upper.size() == 50 && *upper.begin() == 0);
+    report("split and join");
+}
+
+// a holds the multiples of sa below n, b the multiples of sb offset by
+// off; checks each operation against membership computed directly
+template <class Tree>
+static bool set_algebra_matches(int n, int sa, int sb, int off) {
+    Tree a;
+    Tree b;
+    for (int i = 0; i < n; i += sa)
+        a.insert(i);
+    for (int i = off; i < n; i += sb)
+        b.insert(i);
+    bool ok = true;
+    for (int op = 0; op < 3; ++op) {
+        Tree t(a);
+        if (op == 0)
+            t.unite(b);
+        else if (op == 1)
+            t.intersect(b);
+        else
+            t.subtract(b);
+        ok = ok && t.verify() && b.verify();
+        size_t expect = 0;
+        for (int i = 0; i < n; ++i) {
+            bool in_a = i % sa == 0;
+            bool in_b = i >= off && (i - off) % sb == 0;
+            bool in = op == 0 ? in_a || in_b : op == 1 ? in_a && in_b : in_a && !in_b;
+            if (in)
+                ++expect;
+            ok = ok && (t.count(i) == 1) == in;
+        }
+        ok = ok && t.size() == expect;
+    }
+    return ok;
+}
+
+static void test_set_algebra() {
+    bool ok = true;
+    int strides[] = { 1, 2, 3, 7, 50, 999 };
+    size_t k = sizeof(strides) / sizeof(strides[0]);
+    for (size_t i = 0; i < k; ++i) {
+        for (size_t j = 0; j < k; ++j) {
+            ok = ok && set_algebra_matches<plain_tree>(1000, strides[i], strides[j], 0);
+            ok = ok && set_algebra_matches<plain_tree>(1000, strides[i], strides[j], 1);
+            ok = ok && set_algebra_matches<ranked_tree>(1000, strides[i], strides[j], 5);
+        }
+    }
+    ok = ok && set_algebra_matches<plain_tree>(0, 1, 1, 0);
+    ok = ok && set_algebra_matches<plain_tree>(10, 1, 1, 20);
+    CHECK(ok);
+
+    // A few keys against a big tree cost about m log(n/m), not n
+    plain_tree big;
+    plain_tree few;
+    for (int i = 0; i < 100000; ++i)
+        big.insert(i);
+    for (int i = 0; i < 10; ++i)
+        few.insert(i * 10000 + 7);
+    plain_tree t(big);
+    CountingLess::calls = 0;
+    t.intersect(few);
+    CHECK(CountingLess::calls < 5000 && t.verify() && t.size() == 10);
+    t = big;
+    CountingLess::calls = 0;
+    t.subtract(few);
+    CHECK(CountingLess::calls < 5000 && t.verify() && t.size() == 99990);
+    t = few;
+    CountingLess::calls = 0;
+    t.intersect(big);
+    CHECK(CountingLess::calls < 5000 && t.verify() && t.size() == 10);
+
+    // map keeps its own mapped values; pooled nodes stay in the right pool
+    pooled_map m;
+    pooled_map other;
+    for (int i = 0; i < 100; ++i) {
+        m[i] = i;
+        other[i + 50] = -1;
+    }
+    m.unite(other);
+    CHECK(m.size() == 150 && m[60] == 60 && m[120] == -1);
+    m.subtract(other);
+    CHECK(m.size() == 50 && m.count(50) == 0 && m[49] == 49);
+    other.clear();
+    m.intersect(other);
+    CHECK(m.empty());
+    report("set algebra");
+}
+
+static void test_duplicates() {
+    // multiset keeps every copy, whichever path the element takes
+    ft::multiset<int> ms;
+    ms.insert(1);
+    ms.insert(1);
+    ms.insert(ms.begin(), 1);
+    int more[] = { 2, 1, 2 };
+    ms.insert(more, more + 3);
+    CHECK(ms.size() == 6 && ms.count(1) == 4 && ms.count(2) == 2);
+    ft::pair<ft::multiset<int>::iterator, ft::multiset<int>::iterator> r = ms.equal_range(1);
+    size_t n = 0;
+    for (; r.first != r.second; ++r.first)
+        ++n;
+    CHECK(n == 4);
+    ms.erase(ms.begin());
+    CHECK(ms.count(1) == 3);
+    CHECK(ms.erase(1) == 3 && ms.size() == 2);
+    int sorted[] = { 0, 0, 3, 3, 3 };
+    ft::multiset<int> from_sorted(ft::sorted_range, sorted, sorted + 5);
+    CHECK(from_sorted.size() == 5 && from_sorted.count(3) == 3);
+    from_sorted.erase(from_sorted.begin(), from_sorted.lower_bound(3));
+    CHECK(from_sorted.size() == 3);
+
+    // merge and node handles between multisets keep duplicates
+    ft::multiset<int> other(more, more + 3);
+    ms.merge(other);
+    CHECK(other.empty() && ms.size() == 5 && ms.count(2) == 4);
+    ft::multiset<int>::node_type nh = ms.extract(2);
+    ms.insert(nh);
+    CHECK(nh.empty() && ms.count(2) == 4);
+
+    // set drops them: merge leaves the duplicates behind in the source
+    ft::set<int> st(more, more + 3);
+    CHECK(st.size() == 2);
+    st.insert(st.begin(), 2);
+    CHECK(st.size() == 2);
+    ft::set<int> dup;
+    dup.insert(2);
+    dup.insert(7);
+    st.merge(dup);
+    CHECK(st.size() == 3 && dup.size() == 1 && *dup.begin() == 2);
+    ft::set<int>::node_type sh = dup.extract(2);
+    ft::pair<ft::set<int>::iterator, bool> res = st.insert(sh);
+    CHECK(!res.second && !sh.empty() && *res.first == 2);
+
+    // multimap keeps equal keys in insertion order through merge
+    ft::multimap<int, int> mm;
+    ft::multimap<int, int> mm2;
+    mm.insert(ft::make_pair(1, 10));
+    mm.insert(ft::make_pair(1, 11));
+    mm2.insert(ft::make_pair(1, 20));
+    mm2.insert(ft::make_pair(0, 0));
+    mm.merge(mm2);
+    CHECK(mm2.empty() && mm.size() == 4 && mm.count(1) == 3);
+    ft::multimap<int, int>::iterator it = mm.lower_bound(1);
+    CHECK(it->second == 10 && (++it)->second == 11 && (++it)->second == 20);
+    ft::map<int, int> m;
+    ft::map<int, int> m2;
+    m[1] = 1;
+    m2[1] = 2;
+    m2[2] = 2;
+    m.merge(m2);
+    CHECK(m.size() == 2 && m[1] == 1 && m2.size() == 1 && m2.begin()->second == 2);
+
+    // Handles straight from extract(); a rejected one frees its node
+    CHECK(m.insert(m2.extract(1)).second == false && m2.empty());
+    m2[5] = 5;
+    CHECK(m.insert(m2.extract(5)).second && m[5] == 5 && m2.empty());
+    other.insert(ms.extract(2));
+    CHECK(other.size() == 1 && *other.begin() == 2 && ms.count(2) == 3);
+    dup.insert(9);
+    CHECK(st.insert(dup.extract(9)).second && dup.empty() && st.count(9) == 1);
+    mm2.insert(mm.extract(0));
+    CHECK(mm2.size() == 1 && mm.size() == 3);
+    pooled_map pa;
+    pooled_map pb;
+    pa[1] = 1;
+    CHECK(pb.insert(pa.extract(1)).second && pa.empty() && pb[1] == 1);
+    report("duplicates");
+}
+
+// Counts every construction, so a lookup that converts its argument
+// to the key type shows up
+struct CountedKey {
+    int id;
+    static int made;
+    CountedKey(int i) : id(i) { ++made; }
+    CountedKey(const CountedKey& other) : id(other.id) { ++made; }
+};
+
+int CountedKey::made = 0;
+
+struct ById {
+    typedef void is_transparent;
+    bool operator()(const CountedKey& a, const CountedKey& b) const { return a.id < b.id; }
+    bool operator()(const CountedKey& a, int b) const { return a.id < b; }
+    bool operator()(int a, const CountedKey& b) const { return a < b.id; }
+};
+
+struct ByIdOnly {
+    bool operator()(const CountedKey& a, const CountedKey& b) const { return a.id < b.id; }
+};
+
+static void test_transparent_lookup() {
+    ft::set<CountedKey, ById> s;
+    ft::multiset<CountedKey, ById> ms;
+    for (int i = 0; i < 10; i += 2) {
+        s.insert(CountedKey(i));
+        ms.insert(CountedKey(i));
+        ms.insert(CountedKey(i));
+    }
+    const ft::set<CountedKey, ById>& cs = s;
+    CountedKey::made = 0;
+    CHECK(s.find(4) != s.end() && s.find(4)->id == 4 && s.find(5) == s.end());
+    CHECK(cs.find(8)->id == 8 && s.count(4) == 1 && s.count(5) == 0);
+    CHECK(s.lower_bound(5)->id == 6 && cs.lower_bound(4)->id == 4);
+    CHECK(s.upper_bound(6)->id == 8 && cs.upper_bound(8) == cs.end());
+    ft::pair<ft::set<CountedKey, ById>::iterator, ft::set<CountedKey, ById>::iterator> r = s.equal_range(2);
+    CHECK(r.first->id == 2 && r.second->id == 4);
+    r = s.equal_range(3);
+    CHECK(r.first == r.second && r.first->id == 4);
+    CHECK(ms.count(4) == 2 && ms.count(3) == 0 && ms.lower_bound(4) != ms.upper_bound(4));
+    CHECK(ms.find(6)->id == 6 && ms.upper_bound(-1) == ms.begin());
+    ft::pair<ft::multiset<CountedKey, ById>::iterator, ft::multiset<CountedKey, ById>::iterator> mr = ms.equal_range(8);
+    CHECK(mr.first->id == 8 && ++mr.first != mr.second && ++mr.first == mr.second);
+    CHECK(CountedKey::made == 0);
+
+    // Without is_transparent the argument is converted, as before
+    ft::set<CountedKey, ByIdOnly> plain;
+    plain.insert(CountedKey(1));
+    CountedKey::made = 0;
+    CHECK(plain.count(1) == 1 && CountedKey::made == 1);
+
+    ft::map<std::string, int, ft::less<> > m;
+    ft::multimap<std::string, int, ft::less<> > mm;
+    const char* words[] = { "apple", "banana", "cherry" };
+    for (int i = 0; i < 3; ++i) {
+        m[words[i]] = i;
+        mm.insert(ft::make_pair(std::string(words[i]), i));
+        mm.insert(ft::make_pair(std::string(words[i]), i + 10));
+    }
+    const char* key = "banana";
+    const ft::map<std::string, int, ft::less<> >& cm = m;
+    CHECK(m.find(key)->second == 1 && cm.find("cherry")->second == 2 && m.find("date") == m.end());
+    CHECK(m.count(key) == 1 && m.count("b") == 0);
+    CHECK(m.lower_bound("b")->first == "banana" && cm.upper_bound(key)->first == "cherry");
+    CHECK(m.equal_range(key).first->second == 1 && m.equal_range("b").first == m.equal_range("b").second);
+    CHECK(mm.count(key) == 2 && mm.lower_bound("c")->second == 2 && mm.upper_bound("c")->second == 2);
+    CHECK(mm.find("apple")->first == "apple" && mm.equal_range(key).second == mm.lower_bound("cherry"));
+    report("transparent lookup");
+}
+
 // Basic tests for all major list functionalities
 int main() {
     // Constructor tests
@@ -301,6 +1686,37 @@ int main() {
     std::allocator<int> alloc = list18.get_allocator();
     std::cout << "Default allocator is working correctly." << std::endl;
     
+    std::cout << std::endl << "===== CONTAINER EXTENSION TESTS =====" << std::endl;
+    test_range_compare();
+    test_parallel_construct();
+    test_append_aliasing();
+    test_trim();
+    test_segmented_vector();
+    test_soa_vector();
+    test_vector_bool();
+    test_compressed_int_vector();
+    test_buffer_pool();
+    test_aligned_allocator();
+    test_concurrent_vector();
+    test_incremental_vector();
+    test_cow_vector();
+    test_node_pool_allocator();
+    test_hinted_insert();
+    test_sorted_construction();
+    test_single_descent();
+    test_cached_extremes();
+    test_node_layout();
+    test_slim_iterators();
+    test_order_statistics();
+    test_split_join();
+    test_set_algebra();
+    test_duplicates();
+    test_transparent_lookup();
+
+    if (g_failures) {
+        std::cout << std::endl << g_failures << " check(s) failed" << std::endl;
+        return 1;
+    }
     std::cout << std::endl << "All tests completed successfully!" << std::endl;
     
     return 0;
@@ -5,20 +5,23 @@
 
 namespace ft
 {
-    // Forward declarations
+    // Forward declarations. A Ranked map keeps subtree sizes in its
+    // nodes, one word each, so nth(), rank(), index_of() and count_range()
+    // run in O(log n) instead of walking the elements.
     template <class Key, class T, class Compare = std::less<Key>,
-              class Allocator = std::allocator<ft::pair<const Key, T> > >
+              class Allocator = std::allocator<ft::pair<const Key, T> >,
+              bool Ranked = false>
     class map;
 
-    template <class Key, class T, class Compare, class Allocator>
-    bool operator==(const map<Key, T, Compare, Allocator>& lhs,
-                   const map<Key, T, Compare, Allocator>& rhs);
+    template <class Key, class T, class Compare, class Allocator, bool Ranked>
+    bool operator==(const map<Key, T, Compare, Allocator, Ranked>& lhs,
+                   const map<Key, T, Compare, Allocator, Ranked>& rhs);
 
-    template <class Key, class T, class Compare, class Allocator>
-    bool operator<(const map<Key, T, Compare, Allocator>& lhs,
-                  const map<Key, T, Compare, Allocator>& rhs);
+    template <class Key, class T, class Compare, class Allocator, bool Ranked>
+    bool operator<(const map<Key, T, Compare, Allocator, Ranked>& lhs,
+                  const map<Key, T, Compare, Allocator, Ranked>& rhs);
 
-    template <class Key, class T, class Compare, class Allocator>
+    template <class Key, class T, class Compare, class Allocator, bool Ranked>
     class map
     {
     public:
@@ -48,7 +51,7 @@ namespace ft
         };
 
     private:
-        typedef ft::multimap<Key, T, Compare, Allocator> multimap_type;
+        typedef ft::multimap<Key, T, Compare, Allocator, Ranked> multimap_type;
         multimap_type _multimap;
 
     public:
@@ -56,6 +59,7 @@ namespace ft
         typedef typename multimap_type::const_iterator         const_iterator;
         typedef typename multimap_type::reverse_iterator       reverse_iterator;
         typedef typename multimap_type::const_reverse_iterator const_reverse_iterator;
+        typedef typename multimap_type::node_type              node_type;
 
         // Constructors
         explicit map(const key_compare& comp = key_compare(),
@@ -71,6 +75,16 @@ namespace ft
             insert(first, last);
         }
 
+        // [first, last) must be sorted by key with no key repeated
+        template <class InputIterator>
+        map(ft::sorted_range_tag, InputIterator first, InputIterator last,
+           const key_compare& comp = key_compare(),
+           const allocator_type& alloc = allocator_type())
+            : _multimap(comp, alloc)
+        {
+            _multimap._tree.assign_sorted(first, last, true);
+        }
+
         map(const map& x) : _multimap(x._multimap) {}
 
         ~map() {}
@@ -100,10 +114,7 @@ namespace ft
         // Element access
         mapped_type& operator[](const key_type& k)
         {
-            iterator it = find(k);
-            if (it == end())
-                it = _multimap.insert(ft::make_pair(k, mapped_type()));
-            return it->second;
+            return _multimap._tree.try_emplace(k).first->second;
         }
 
         mapped_type& at(const key_type& k)
@@ -125,25 +136,40 @@ namespace ft
         // Modifiers
         ft::pair<iterator, bool> insert(const value_type& val)
         {
-            iterator it = find(val.first);
-            if (it != end())
-                return ft::make_pair(it, false);
-            return ft::make_pair(_multimap.insert(val), true);
+            return _multimap._tree.insert(val);
         }
 
         iterator insert(iterator position, const value_type& val)
         {
-            iterator it = find(val.first);
-            if (it != end())
-                return it;
-            return _multimap.insert(position, val);
+            return _multimap._tree.insert(position, val);
         }
 
         template <class InputIterator>
         void insert(InputIterator first, InputIterator last)
         {
-            for (; first != last; ++first)
-                insert(*first);
+            _multimap._tree.insert_range(first, last);
+        }
+
+        // Inserts (k, obj) unless k is already present, in which case
+        // nothing is built or assigned
+        ft::pair<iterator, bool> try_emplace(const key_type& k, const mapped_type& obj)
+        {
+            return _multimap._tree.try_emplace(k, obj);
+        }
+
+        // Inserts (k, mapped_type()) unless k is already present
+        ft::pair<iterator, bool> try_emplace(const key_type& k)
+        {
+            return _multimap._tree.try_emplace(k);
+        }
+
+        // Inserts (k, obj), or assigns obj to the existing element for k
+        ft::pair<iterator, bool> insert_or_assign(const key_type& k, const mapped_type& obj)
+        {
+            ft::pair<iterator, bool> res = _multimap._tree.try_emplace(k, obj);
+            if (!res.second)
+                res.first->second = obj;
+            return res;
         }
 
         void erase(iterator position)
@@ -165,11 +191,37 @@ namespace ft
             _multimap.erase(first, last);
         }
 
+        // Node handles: the element moves between containers, or gets a new
+        // key, without being copied or reallocated
+        node_type extract(iterator position) { return _multimap.extract(position); }
+        node_type extract(const key_type& k) { return _multimap.extract(k); }
+
+        // nh keeps its node if the key is already present
+        ft::pair<iterator, bool> insert(const node_type& nh) { return _multimap._tree.insert(nh); }
+
+        // Moves over the elements of x whose key is not present here,
+        // without copying them; the others stay in x
+        void merge(map& x) { _multimap._tree.merge(x._multimap._tree); }
+
         void swap(map& x)
         {
             _multimap.swap(x._multimap);
         }
 
+        // Moves the elements keyed from k on into out (see rb_tree::split)
+        void split(const key_type& k, map& out) { _multimap._tree.split(k, out._multimap._tree); }
+
+        // Moves every element of other in, in O(log n); all of other's keys
+        // must order before or after all of ours (std::invalid_argument)
+        void join(map& other) { _multimap._tree.join(other._multimap._tree); }
+
+        // In-place union, intersection and difference by key, keeping our
+        // mapped values; O(m log(n/m + 1)) for sizes m <= n (see
+        // rb_tree::unite)
+        void unite(const map& other) { _multimap._tree.unite(other._multimap._tree); }
+        void intersect(const map& other) { _multimap._tree.intersect(other._multimap._tree); }
+        void subtract(const map& other) { _multimap._tree.subtract(other._multimap._tree); }
+
         void clear()
         {
             _multimap.clear();
@@ -199,7 +251,7 @@ namespace ft
 
         size_type count(const key_type& k) const
         {
-            return _multimap.count(k) > 0 ? 1 : 0;
+            return _multimap._tree.count(k);
         }
 
         iterator lower_bound(const key_type& k)
@@ -232,6 +284,75 @@ namespace ft
             return _multimap.equal_range(k);
         }
 
+        // Heterogeneous lookup
+        template <class K>
+        typename _if_transparent<key_compare, K, iterator>::type find(const K& k)
+        {
+            return _multimap.find(k);
+        }
+
+        template <class K>
+        typename _if_transparent<key_compare, K, const_iterator>::type find(const K& k) const
+        {
+            return _multimap.find(k);
+        }
+
+        template <class K>
+        typename _if_transparent<key_compare, K, size_type>::type count(const K& k) const
+        {
+            return _multimap._tree.count(k);
+        }
+
+        template <class K>
+        typename _if_transparent<key_compare, K, iterator>::type lower_bound(const K& k)
+        {
+            return _multimap.lower_bound(k);
+        }
+
+        template <class K>
+        typename _if_transparent<key_compare, K, const_iterator>::type lower_bound(const K& k) const
+        {
+            return _multimap.lower_bound(k);
+        }
+
+        template <class K>
+        typename _if_transparent<key_compare, K, iterator>::type upper_bound(const K& k)
+        {
+            return _multimap.upper_bound(k);
+        }
+
+        template <class K>
+        typename _if_transparent<key_compare, K, const_iterator>::type upper_bound(const K& k) const
+        {
+            return _multimap.upper_bound(k);
+        }
+
+        template <class K>
+        typename _if_transparent<key_compare, K, ft::pair<iterator, iterator> >::type equal_range(const K& k)
+        {
+            return _multimap.equal_range(k);
+        }
+
+        template <class K>
+        typename _if_transparent<key_compare, K, ft::pair<const_iterator, const_iterator> >::type
+        equal_range(const K& k) const
+        {
+            return _multimap.equal_range(k);
+        }
+
+        // Order statistics, O(log n) when Ranked and linear otherwise
+        iterator nth(size_type k) { return _multimap.nth(k); }
+        const_iterator nth(size_type k) const { return _multimap.nth(k); }
+
+        size_type rank(const key_type& k) const { return _multimap.rank(k); }
+
+        size_type index_of(const_iterator position) const { return _multimap.index_of(position); }
+
+        size_type count_range(const key_type& lo, const key_type& hi) const
+        {
+            return _multimap.count_range(lo, hi);
+        }
+
         allocator_type get_allocator() const
         {
             return _multimap.get_allocator();
@@ -239,15 +360,15 @@ namespace ft
     };
 
     // Non-member functions
-    template <class Key, class T, class Compare, class Allocator>
-    bool operator==(const map<Key, T, Compare, Allocator>& lhs,
-                   const map<Key, T, Compare, Allocator>& rhs)
+    template <class Key, class T, class Compare, class Allocator, bool Ranked>
+    bool operator==(const map<Key, T, Compare, Allocator, Ranked>& lhs,
+                   const map<Key, T, Compare, Allocator, Ranked>& rhs)
     {
         if (lhs.size() != rhs.size())
             return false;
         
-        typename map<Key, T, Compare, Allocator>::const_iterator lit = lhs.begin();
-        typename map<Key, T, Compare, Allocator>::const_iterator rit = rhs.begin();
+        typename map<Key, T, Compare, Allocator, Ranked>::const_iterator lit = lhs.begin();
+        typename map<Key, T, Compare, Allocator, Ranked>::const_iterator rit = rhs.begin();
         
         for (; lit != lhs.end() && rit != rhs.end(); ++lit, ++rit)
         {
@@ -257,19 +378,19 @@ namespace ft
         return lit == lhs.end() && rit == rhs.end();
     }
 
-    template <class Key, class T, class Compare, class Allocator>
-    bool operator!=(const map<Key, T, Compare, Allocator>& lhs,
-                   const map<Key, T, Compare, Allocator>& rhs)
+    template <class Key, class T, class Compare, class Allocator, bool Ranked>
+    bool operator!=(const map<Key, T, Compare, Allocator, Ranked>& lhs,
+                   const map<Key, T, Compare, Allocator, Ranked>& rhs)
     {
         return !(lhs == rhs);
     }
 
-    template <class Key, class T, class Compare, class Allocator>
-    bool operator<(const map<Key, T, Compare, Allocator>& lhs,
-                  const map<Key, T, Compare, Allocator>& rhs)
+    template <class Key, class T, class Compare, class Allocator, bool Ranked>
+    bool operator<(const map<Key, T, Compare, Allocator, Ranked>& lhs,
+                  const map<Key, T, Compare, Allocator, Ranked>& rhs)
     {
-        typename map<Key, T, Compare, Allocator>::const_iterator lit = lhs.begin();
-        typename map<Key, T, Compare, Allocator>::const_iterator rit = rhs.begin();
+        typename map<Key, T, Compare, Allocator, Ranked>::const_iterator lit = lhs.begin();
+        typename map<Key, T, Compare, Allocator, Ranked>::const_iterator rit = rhs.begin();
         
         for (; lit != lhs.end() && rit != rhs.end(); ++lit, ++rit)
         {
@@ -281,30 +402,30 @@ namespace ft
         return lit != lhs.end() ? false : rit != rhs.end();
     }
 
-    template <class Key, class T, class Compare, class Allocator>
-    bool operator<=(const map<Key, T, Compare, Allocator>& lhs,
-                   const map<Key, T, Compare, Allocator>& rhs)
+    template <class Key, class T, class Compare, class Allocator, bool Ranked>
+    bool operator<=(const map<Key, T, Compare, Allocator, Ranked>& lhs,
+                   const map<Key, T, Compare, Allocator, Ranked>& rhs)
     {
         return !(rhs < lhs);
     }
 
-    template <class Key, class T, class Compare, class Allocator>
-    bool operator>(const map<Key, T, Compare, Allocator>& lhs,
-                  const map<Key, T, Compare, Allocator>& rhs)
+    template <class Key, class T, class Compare, class Allocator, bool Ranked>
+    bool operator>(const map<Key, T, Compare, Allocator, Ranked>& lhs,
+                  const map<Key, T, Compare, Allocator, Ranked>& rhs)
     {
         return rhs < lhs;
     }
 
-    template <class Key, class T, class Compare, class Allocator>
-    bool operator>=(const map<Key, T, Compare, Allocator>& lhs,
-                   const map<Key, T, Compare, Allocator>& rhs)
+    template <class Key, class T, class Compare, class Allocator, bool Ranked>
+    bool operator>=(const map<Key, T, Compare, Allocator, Ranked>& lhs,
+                   const map<Key, T, Compare, Allocator, Ranked>& rhs)
     {
         return !(lhs < rhs);
     }
 
-    template <class Key, class T, class Compare, class Allocator>
-    void swap(map<Key, T, Compare, Allocator>& x,
-             map<Key, T, Compare, Allocator>& y)
+    template <class Key, class T, class Compare, class Allocator, bool Ranked>
+    void swap(map<Key, T, Compare, Allocator, Ranked>& x,
+             map<Key, T, Compare, Allocator, Ranked>& y)
     {
         x.swap(y);
     }
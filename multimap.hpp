@@ -8,8 +8,14 @@
 
 namespace ft
 {
+    template <class Key, class T, class Compare, class Allocator, bool Ranked>
+    class map;
+
+    // Ranked keeps subtree sizes for O(log n) order statistics and count();
+    // see map.hpp
     template <class Key, class T, class Compare = std::less<Key>, 
-              class Allocator = std::allocator<ft::pair<const Key, T> > >
+              class Allocator = std::allocator<ft::pair<const Key, T> >,
+              bool Ranked = false>
     class multimap
     {
     public:
@@ -52,14 +58,18 @@ namespace ft
         };
 
     private:
-        typedef rb_tree<Key, value_type, key_of_value, key_compare, allocator_type> tree_type;
+        typedef rb_tree<Key, value_type, key_of_value, key_compare, allocator_type, Ranked> tree_type;
         tree_type _tree;
 
+        // map keeps its elements in a multimap and uses the unique inserts
+        friend class map<Key, T, Compare, Allocator, Ranked>;
+
     public:
         typedef typename tree_type::iterator                 iterator;
         typedef typename tree_type::const_iterator           const_iterator;
         typedef typename tree_type::reverse_iterator         reverse_iterator;
         typedef typename tree_type::const_reverse_iterator   const_reverse_iterator;
+        typedef typename tree_type::node_handle              node_type;
 
         // Constructors
         explicit multimap(const key_compare& comp = key_compare(),
@@ -75,6 +85,16 @@ namespace ft
             insert(first, last);
         }
 
+        // [first, last) must be sorted by key
+        template <class InputIterator>
+        multimap(ft::sorted_range_tag, InputIterator first, InputIterator last,
+                const key_compare& comp = key_compare(),
+                const allocator_type& alloc = allocator_type())
+            : _tree(comp, alloc)
+        {
+            _tree.assign_sorted(first, last, false);
+        }
+
         multimap(const multimap& x) : _tree(x._tree) {}
 
         // Destructor
@@ -116,8 +136,7 @@ namespace ft
         template <class InputIterator>
         void insert(InputIterator first, InputIterator last)
         {
-            for (; first != last; ++first)
-                insert(*first);
+            _tree.insert_range_multi(first, last);
         }
 
         void erase(iterator position)
@@ -135,11 +154,29 @@ namespace ft
             _tree.erase(first, last);
         }
 
+        // Node handles: the element moves between containers, or gets a new
+        // key, without being copied or reallocated
+        node_type extract(iterator position) { return _tree.extract(position); }
+        node_type extract(const key_type& k) { return _tree.extract(k); }
+
+        iterator insert(const node_type& nh) { return _tree.insert_multi(nh); }
+
+        // Moves every element of x over, without copying them
+        void merge(multimap& x) { _tree.merge_multi(x._tree); }
+
         void swap(multimap& x)
         {
             _tree.swap(x._tree);
         }
 
+        // Moves the elements keyed from k on into out (see rb_tree::split)
+        void split(const key_type& k, multimap& out) { _tree.split(k, out._tree); }
+
+        // Moves every element of other in, in O(log n); other's keys must
+        // all order before or after ours, equal keys only at the seam
+        // (std::invalid_argument otherwise)
+        void join(multimap& other) { _tree.join_multi(other._tree); }
+
         void clear()
         {
             _tree.clear();
@@ -202,6 +239,75 @@ namespace ft
             return _tree.equal_range(k);
         }
 
+        // Heterogeneous lookup
+        template <class K>
+        typename _if_transparent<key_compare, K, iterator>::type find(const K& k)
+        {
+            return _tree.find(k);
+        }
+
+        template <class K>
+        typename _if_transparent<key_compare, K, const_iterator>::type find(const K& k) const
+        {
+            return _tree.find(k);
+        }
+
+        template <class K>
+        typename _if_transparent<key_compare, K, size_type>::type count(const K& k) const
+        {
+            return _tree.count_multi(k);
+        }
+
+        template <class K>
+        typename _if_transparent<key_compare, K, iterator>::type lower_bound(const K& k)
+        {
+            return _tree.lower_bound(k);
+        }
+
+        template <class K>
+        typename _if_transparent<key_compare, K, const_iterator>::type lower_bound(const K& k) const
+        {
+            return _tree.lower_bound(k);
+        }
+
+        template <class K>
+        typename _if_transparent<key_compare, K, iterator>::type upper_bound(const K& k)
+        {
+            return _tree.upper_bound(k);
+        }
+
+        template <class K>
+        typename _if_transparent<key_compare, K, const_iterator>::type upper_bound(const K& k) const
+        {
+            return _tree.upper_bound(k);
+        }
+
+        template <class K>
+        typename _if_transparent<key_compare, K, ft::pair<iterator, iterator> >::type equal_range(const K& k)
+        {
+            return _tree.equal_range(k);
+        }
+
+        template <class K>
+        typename _if_transparent<key_compare, K, ft::pair<const_iterator, const_iterator> >::type
+        equal_range(const K& k) const
+        {
+            return _tree.equal_range(k);
+        }
+
+        // Order statistics, O(log n) when Ranked and linear otherwise
+        iterator nth(size_type k) { return _tree.nth(k); }
+        const_iterator nth(size_type k) const { return _tree.nth(k); }
+
+        size_type rank(const key_type& k) const { return _tree.rank(k); }
+
+        size_type index_of(const_iterator position) const { return _tree.index_of(position); }
+
+        size_type count_range(const key_type& lo, const key_type& hi) const
+        {
+            return _tree.count_range(lo, hi);
+        }
+
         // Allocator
         allocator_type get_allocator() const
         {
@@ -210,53 +316,53 @@ namespace ft
     };
 
     // Non-member function overloads
-    template <class Key, class T, class Compare, class Alloc>
-    bool operator==(const multimap<Key, T, Compare, Alloc>& lhs,
-                   const multimap<Key, T, Compare, Alloc>& rhs)
+    template <class Key, class T, class Compare, class Alloc, bool Ranked>
+    bool operator==(const multimap<Key, T, Compare, Alloc, Ranked>& lhs,
+                   const multimap<Key, T, Compare, Alloc, Ranked>& rhs)
     {
         return lhs.size() == rhs.size() && 
                ft::equal(lhs.begin(), lhs.end(), rhs.begin());
     }
 
-    template <class Key, class T, class Compare, class Alloc>
-    bool operator!=(const multimap<Key, T, Compare, Alloc>& lhs,
-                   const multimap<Key, T, Compare, Alloc>& rhs)
+    template <class Key, class T, class Compare, class Alloc, bool Ranked>
+    bool operator!=(const multimap<Key, T, Compare, Alloc, Ranked>& lhs,
+                   const multimap<Key, T, Compare, Alloc, Ranked>& rhs)
     {
         return !(lhs == rhs);
     }
 
-    template <class Key, class T, class Compare, class Alloc>
-    bool operator<(const multimap<Key, T, Compare, Alloc>& lhs,
-                  const multimap<Key, T, Compare, Alloc>& rhs)
+    template <class Key, class T, class Compare, class Alloc, bool Ranked>
+    bool operator<(const multimap<Key, T, Compare, Alloc, Ranked>& lhs,
+                  const multimap<Key, T, Compare, Alloc, Ranked>& rhs)
     {
         return ft::lexicographical_compare(lhs.begin(), lhs.end(),
                                           rhs.begin(), rhs.end());
     }
 
-    template <class Key, class T, class Compare, class Alloc>
-    bool operator<=(const multimap<Key, T, Compare, Alloc>& lhs,
-                   const multimap<Key, T, Compare, Alloc>& rhs)
+    template <class Key, class T, class Compare, class Alloc, bool Ranked>
+    bool operator<=(const multimap<Key, T, Compare, Alloc, Ranked>& lhs,
+                   const multimap<Key, T, Compare, Alloc, Ranked>& rhs)
     {
         return !(rhs < lhs);
     }
 
-    template <class Key, class T, class Compare, class Alloc>
-    bool operator>(const multimap<Key, T, Compare, Alloc>& lhs,
-                  const multimap<Key, T, Compare, Alloc>& rhs)
+    template <class Key, class T, class Compare, class Alloc, bool Ranked>
+    bool operator>(const multimap<Key, T, Compare, Alloc, Ranked>& lhs,
+                  const multimap<Key, T, Compare, Alloc, Ranked>& rhs)
     {
         return rhs < lhs;
     }
 
-    template <class Key, class T, class Compare, class Alloc>
-    bool operator>=(const multimap<Key, T, Compare, Alloc>& lhs,
-                   const multimap<Key, T, Compare, Alloc>& rhs)
+    template <class Key, class T, class Compare, class Alloc, bool Ranked>
+    bool operator>=(const multimap<Key, T, Compare, Alloc, Ranked>& lhs,
+                   const multimap<Key, T, Compare, Alloc, Ranked>& rhs)
     {
         return !(lhs < rhs);
     }
 
-    template <class Key, class T, class Compare, class Alloc>
-    void swap(multimap<Key, T, Compare, Alloc>& x,
-             multimap<Key, T, Compare, Alloc>& y)
+    template <class Key, class T, class Compare, class Alloc, bool Ranked>
+    void swap(multimap<Key, T, Compare, Alloc, Ranked>& x,
+             multimap<Key, T, Compare, Alloc, Ranked>& y)
     {
         x.swap(y);
     }
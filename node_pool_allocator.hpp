@@ -0,0 +1,214 @@
+#ifndef NODE_POOL_ALLOCATOR_HPP
+#define NODE_POOL_ALLOCATOR_HPP
+
+#include <new>
+#include <cstddef>
+
+namespace ft
+{
+    // Free list of single T-sized slots carved out of chunks that double in
+    // size up to max_chunk slots. Released slots are reused, never returned
+    // to the heap; the chunks go away with the last allocator using the pool.
+    template <class T>
+    class _node_pool
+    {
+    public:
+        static const size_t first_chunk = 32;
+        static const size_t max_chunk = 4096;
+
+        _node_pool() : refs(1), _free(NULL), _chunks(NULL), _bump(NULL), _bump_end(NULL), _next_chunk(first_chunk) {}
+
+        ~_node_pool()
+        {
+            while (_chunks)
+            {
+                _chunk *next = _chunks->next;
+                ::operator delete(_chunks);
+                _chunks = next;
+            }
+        }
+
+        void *allocate()
+        {
+            if (_free)
+            {
+                _slot *s = _free;
+                _free = s->next;
+                return s;
+            }
+            if (_bump == _bump_end)
+                _add_chunk();
+            void *p = _bump;
+            _bump += _stride;
+            return p;
+        }
+
+        void deallocate(void *p)
+        {
+            _slot *s = static_cast<_slot*>(p);
+            s->next = _free;
+            _free = s;
+        }
+
+        size_t refs;
+
+    private:
+        struct _slot
+        {
+            _slot *next;
+        };
+
+        struct _chunk
+        {
+            _chunk *next;
+        };
+
+        static const size_t _align = __alignof__(T) > __alignof__(_slot) ? __alignof__(T) : __alignof__(_slot);
+        static const size_t _size = sizeof(T) > sizeof(_slot) ? sizeof(T) : sizeof(_slot);
+        static const size_t _stride = (_size + _align - 1) / _align * _align;
+        static const size_t _header = (sizeof(_chunk) + _align - 1) / _align * _align;
+
+        _slot *_free;
+        _chunk *_chunks;
+        char *_bump;
+        char *_bump_end;
+        size_t _next_chunk;
+
+        _node_pool(const _node_pool &);
+        _node_pool &operator=(const _node_pool &);
+
+        void _add_chunk()
+        {
+            char *raw = static_cast<char*>(::operator new(_header + _next_chunk * _stride));
+            _chunk *c = reinterpret_cast<_chunk*>(raw);
+            c->next = _chunks;
+            _chunks = c;
+            _bump = raw + _header;
+            _bump_end = _bump + _next_chunk * _stride;
+            if (_next_chunk < max_chunk)
+                _next_chunk *= 2;
+        }
+    };
+
+    template <class T>
+    const size_t _node_pool<T>::first_chunk;
+
+    template <class T>
+    const size_t _node_pool<T>::max_chunk;
+
+    // Allocator for node-based containers: single-object requests (one tree
+    // node each) come from a chunked free list instead of operator new, so
+    // insert/erase churn stops hitting malloc and neighbouring nodes share
+    // cache lines. Larger requests go to operator new.
+    //
+    // Every default-constructed or rebound allocator owns a new pool and
+    // copies share it. A container copy starts a pool of its own (see
+    // select_on_container_copy), and rb_tree rebinds to its node type, which
+    // also starts a fresh pool; so every container gets its own pool and
+    // may live on its own thread. A pool is not thread-safe otherwise.
+    //
+    // The flip side is that two containers never compare equal by
+    // allocator: join, merge and inserting a node handle from another
+    // container copy each element into a new node instead of relinking it.
+    // split is the exception: the output takes over the source's pool, so
+    // the nodes move, and the two containers then share it and must stay
+    // on the same thread.
+    //
+    //     ft::map<int, int, std::less<int>,
+    //             ft::node_pool_allocator<ft::pair<const int, int> > > m;
+    template <class T>
+    class node_pool_allocator
+    {
+    public:
+        typedef T         value_type;
+        typedef T*        pointer;
+        typedef const T*  const_pointer;
+        typedef T&        reference;
+        typedef const T&  const_reference;
+        typedef size_t    size_type;
+        typedef ptrdiff_t difference_type;
+
+        template <class U>
+        struct rebind
+        {
+            typedef node_pool_allocator<U> other;
+        };
+
+    private:
+        _node_pool<T> *_pool;
+
+        template <class> friend class node_pool_allocator;
+
+        // Out of line: once inlined into a copy-and-assign sequence, GCC
+        // cannot see that refs stays positive and flags the shared pool as
+        // used after free
+        __attribute__((noinline)) void _release()
+        {
+            if (--_pool->refs == 0)
+                delete _pool;
+        }
+
+    public:
+        node_pool_allocator() : _pool(new _node_pool<T>()) {}
+
+        node_pool_allocator(const node_pool_allocator &x) : _pool(x._pool) { ++_pool->refs; }
+
+        // A pool only serves one slot size, so rebinding starts a new one
+        template <class U>
+        node_pool_allocator(const node_pool_allocator<U> &) : _pool(new _node_pool<T>()) {}
+
+        ~node_pool_allocator() { _release(); }
+
+        node_pool_allocator &operator=(const node_pool_allocator &x)
+        {
+            ++x._pool->refs;
+            _release();
+            _pool = x._pool;
+            return *this;
+        }
+
+        pointer address(reference x) const { return &x; }
+        const_pointer address(const_reference x) const { return &x; }
+
+        pointer allocate(size_type n, const void * = 0)
+        {
+            if (n == 1)
+                return static_cast<pointer>(_pool->allocate());
+            if (n > max_size())
+                throw std::bad_alloc();
+            return static_cast<pointer>(::operator new(n * sizeof(T)));
+        }
+
+        void deallocate(pointer p, size_type n)
+        {
+            if (n == 1)
+                _pool->deallocate(p);
+            else
+                ::operator delete(p);
+        }
+
+        size_type max_size() const { return size_type(-1) / sizeof(T); }
+
+        void construct(pointer p, const_reference val) { new (static_cast<void*>(p)) T(val); }
+
+        void destroy(pointer p) { p->~T(); }
+
+        friend bool operator==(const node_pool_allocator &lhs, const node_pool_allocator &rhs)
+        {
+            return lhs._pool == rhs._pool;
+        }
+
+        friend bool operator!=(const node_pool_allocator &lhs, const node_pool_allocator &rhs)
+        {
+            return lhs._pool != rhs._pool;
+        }
+    };
+
+    template <class T>
+    node_pool_allocator<T> select_on_container_copy(const node_pool_allocator<T> &)
+    {
+        return node_pool_allocator<T>();
+    }
+}
+
+#endif // NODE_POOL_ALLOCATOR_HPP
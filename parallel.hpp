@@ -0,0 +1,285 @@
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include <cstddef>
+#include <new>
+#include <pthread.h>
+#include <unistd.h>
+#if __cplusplus >= 201103L
+# include <exception>
+#endif
+
+namespace ft
+{
+    // Pass as the extra argument of vector's fill/copy constructors to split
+    // element construction across the shared thread pool. vector.hpp only
+    // declares the tag; include this header to use them.
+    struct parallel_tag {};
+    const parallel_tag parallel = parallel_tag();
+
+    // Process-wide pool of worker threads, started on first use. The calling
+    // thread takes part in every batch, so a single core machine runs with
+    // no workers at all.
+    class thread_pool
+    {
+    public:
+        typedef void (*task_type)(void *ctx, size_t index);
+
+        static thread_pool &instance()
+        {
+            static thread_pool pool;
+            return pool;
+        }
+
+        // Threads that take part in run(), the caller included
+        size_t size() const { return _nthreads + 1; }
+
+        // Calls task(ctx, i) for every i in [0, count) and waits for all of
+        // them. Tasks must not throw.
+        void run(task_type task, void *ctx, size_t count)
+        {
+            pthread_mutex_lock(&_run_mutex);
+            pthread_mutex_lock(&_mutex);
+            _task = task;
+            _ctx = ctx;
+            _next = 0;
+            _count = count;
+            _pending = count;
+            pthread_cond_broadcast(&_work_cond);
+
+            while (_next < _count)
+            {
+                size_t index = _next++;
+                pthread_mutex_unlock(&_mutex);
+                task(ctx, index);
+                pthread_mutex_lock(&_mutex);
+                --_pending;
+            }
+            while (_pending)
+                pthread_cond_wait(&_done_cond, &_mutex);
+
+            _next = 0;
+            _count = 0;
+            pthread_mutex_unlock(&_mutex);
+            pthread_mutex_unlock(&_run_mutex);
+        }
+
+    private:
+        pthread_t       *_threads;
+        size_t          _nthreads;
+        pthread_mutex_t _run_mutex;
+        pthread_mutex_t _mutex;
+        pthread_cond_t  _work_cond;
+        pthread_cond_t  _done_cond;
+        task_type       _task;
+        void            *_ctx;
+        size_t          _next;
+        size_t          _count;
+        size_t          _pending;
+        bool            _stop;
+
+        thread_pool()
+            : _threads(NULL), _nthreads(0), _task(NULL), _ctx(NULL),
+              _next(0), _count(0), _pending(0), _stop(false)
+        {
+            pthread_mutex_init(&_run_mutex, NULL);
+            pthread_mutex_init(&_mutex, NULL);
+            pthread_cond_init(&_work_cond, NULL);
+            pthread_cond_init(&_done_cond, NULL);
+
+            long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+            if (cpus <= 1)
+                return;
+            _threads = new pthread_t[cpus - 1];
+            for (long i = 0; i < cpus - 1; ++i)
+            {
+                if (pthread_create(&_threads[_nthreads], NULL, &thread_pool::_worker, this) != 0)
+                    break;
+                ++_nthreads;
+            }
+        }
+
+        ~thread_pool()
+        {
+            pthread_mutex_lock(&_mutex);
+            _stop = true;
+            pthread_cond_broadcast(&_work_cond);
+            pthread_mutex_unlock(&_mutex);
+
+            for (size_t i = 0; i < _nthreads; ++i)
+                pthread_join(_threads[i], NULL);
+            delete[] _threads;
+
+            pthread_cond_destroy(&_done_cond);
+            pthread_cond_destroy(&_work_cond);
+            pthread_mutex_destroy(&_mutex);
+            pthread_mutex_destroy(&_run_mutex);
+        }
+
+        thread_pool(const thread_pool &);
+        thread_pool &operator=(const thread_pool &);
+
+        static void *_worker(void *arg)
+        {
+            thread_pool *pool = static_cast<thread_pool*>(arg);
+
+            pthread_mutex_lock(&pool->_mutex);
+            while (true)
+            {
+                while (!pool->_stop && pool->_next >= pool->_count)
+                    pthread_cond_wait(&pool->_work_cond, &pool->_mutex);
+                if (pool->_stop)
+                    break;
+
+                size_t index = pool->_next++;
+                task_type task = pool->_task;
+                void *ctx = pool->_ctx;
+                pthread_mutex_unlock(&pool->_mutex);
+                task(ctx, index);
+                pthread_mutex_lock(&pool->_mutex);
+
+                if (--pool->_pending == 0)
+                    pthread_cond_signal(&pool->_done_cond);
+            }
+            pthread_mutex_unlock(&pool->_mutex);
+            return NULL;
+        }
+    };
+
+    // Whether a worker thread may run T's copy constructor. An exception
+    // thrown there has to reach the caller as is, which needs
+    // exception_ptr; before C++11 only types whose copy cannot throw are
+    // built off the calling thread.
+    template <class T>
+    struct _parallel_copy_safe
+    {
+#if __cplusplus >= 201103L
+        static const bool value = true;
+#else
+        static const bool value = __has_nothrow_copy(T);
+#endif
+    };
+
+    template <class Alloc>
+    struct _parallel_construct_job
+    {
+        typedef typename Alloc::pointer    pointer;
+        typedef typename Alloc::value_type value_type;
+
+        static const size_t max_chunks = 64;
+
+        Alloc              *alloc;
+        pointer            dst;
+        const value_type   *src;
+        const value_type   *val;
+        size_t             n;
+        size_t             chunk;
+        bool               failed[max_chunks];
+#if __cplusplus >= 201103L
+        std::exception_ptr error[max_chunks];
+#endif
+
+        // Builds chunk index; on a throw, destroys what it built and
+        // rethrows
+        void construct(size_t index)
+        {
+            size_t first = index * chunk;
+            size_t last = first + chunk < n ? first + chunk : n;
+            size_t i = first;
+
+            try
+            {
+                for (; i < last; ++i)
+                    alloc->construct(dst + i, src ? src[i] : *val);
+            }
+            catch (...)
+            {
+                while (i-- > first)
+                    alloc->destroy(dst + i);
+                throw;
+            }
+        }
+
+        void destroy(size_t index)
+        {
+            size_t last = (index + 1) * chunk < n ? (index + 1) * chunk : n;
+            for (size_t i = index * chunk; i < last; ++i)
+                alloc->destroy(dst + i);
+        }
+
+        static void run(void *ctx, size_t index)
+        {
+            _parallel_construct_job &job = *static_cast<_parallel_construct_job*>(ctx);
+            try
+            {
+                job.construct(index);
+            }
+            catch (...)
+            {
+                job.failed[index] = true;
+#if __cplusplus >= 201103L
+                job.error[index] = std::current_exception();
+#endif
+            }
+        }
+    };
+
+    // Constructs dst[0, n) from src[0, n), or from *val when src is NULL.
+    // If an element constructor throws, nothing is left constructed and
+    // the exception of the lowest failing chunk propagates once every
+    // chunk has finished; no element is constructed twice.
+    template <class Alloc>
+    void parallel_construct(const parallel_tag&, Alloc &alloc, typename Alloc::pointer dst, size_t n,
+                            const typename Alloc::value_type *src,
+                            const typename Alloc::value_type *val)
+    {
+        typedef _parallel_construct_job<Alloc> job_type;
+
+        // Below this many elements per chunk, waking workers costs more than it saves
+        static const size_t min_chunk = 16384;
+
+        thread_pool &pool = thread_pool::instance();
+        size_t chunks = n / min_chunk;
+        if (chunks > pool.size() * 4)
+            chunks = pool.size() * 4;
+        if (chunks > job_type::max_chunks)
+            chunks = job_type::max_chunks;
+        if (chunks == 0 || !_parallel_copy_safe<typename Alloc::value_type>::value)
+            chunks = 1;
+
+        job_type job;
+        job.alloc = &alloc;
+        job.dst = dst;
+        job.src = src;
+        job.val = val;
+        job.n = n;
+        job.chunk = chunks == 1 ? n : (n + chunks - 1) / chunks;
+        for (size_t i = 0; i < chunks; ++i)
+            job.failed[i] = false;
+
+        if (chunks == 1)
+        {
+            job.construct(0);
+            return;
+        }
+        pool.run(&job_type::run, &job, chunks);
+
+        size_t first_failed = 0;
+        while (first_failed < chunks && !job.failed[first_failed])
+            ++first_failed;
+        if (first_failed == chunks)
+            return;
+
+        for (size_t c = 0; c < chunks; ++c)
+            if (!job.failed[c])
+                job.destroy(c);
+#if __cplusplus >= 201103L
+        std::rethrow_exception(job.error[first_failed]);
+#else
+        // Unreachable: workers only copy types whose copy cannot throw
+        throw std::bad_alloc();
+#endif
+    }
+}
+
+#endif // PARALLEL_HPP
@@ -3,33 +3,185 @@
 
 # include <memory>      // std::allocator
 # include <functional>  // std::less
-# include <algorithm>   // std::swap
 # include <cstddef>     // std::ptrdiff_t
 # include <limits>      // std::numeric_limits
+# include <stdexcept>   // std::invalid_argument
 # include "utility.hpp"  // ft::pair
-# include "iterator.hpp" // ft::iterator_traits
+# include "iterator.hpp" // ft::iterator_traits, ft::swap
+# include "functional.hpp" // ft::less<>
 
 namespace ft
 {
+    // Allocator a copied container starts with. Allocators whose copies
+    // must not share state between containers overload this.
+    template <class Alloc>
+    Alloc select_on_container_copy(const Alloc& alloc)
+    {
+        return alloc;
+    }
+
+    // Pass as the first argument of a map/set range constructor to promise
+    // that the range is sorted by key (and, for map and set, free of equal
+    // keys), so the tree is built in O(n) without checking
+    struct sorted_range_tag {};
+    const sorted_range_tag sorted_range = sorted_range_tag();
+
     // Red-Black Tree node colors
     enum rb_tree_color { RED, BLACK };
 
-    // Red-Black Tree node structure
+    // Subtree size kept by the nodes of a ranked tree, counting the node
+    // itself; nothing at all for a plain one, so the accessors can be
+    // called either way and cost nothing when unused
+    template <bool Ranked>
+    struct rb_tree_node_size
+    {
+        size_t subtree_size() const { return 0; }
+        void set_subtree_size(size_t) {}
+    };
+
+    template <>
+    struct rb_tree_node_size<true>
+    {
+        size_t _subtree_size;
+
+        rb_tree_node_size() : _subtree_size(1) {}
 
-    template <class Value>
-    struct rb_tree_node
+        size_t subtree_size() const { return _subtree_size; }
+        void set_subtree_size(size_t n) { _subtree_size = n; }
+    };
+
+    // Red-Black Tree node structure. The color is kept in the low bit of
+    // the parent link, which node alignment always leaves clear, and the
+    // value goes last so that a small value only adds tail padding: on LP64
+    // a set<int> or map<int, int> node takes 32 bytes instead of 40.
+    //
+    // The next bit marks sentinels: a tree's header, which the root's
+    // parent points to, and the leaf() that every missing child points to.
+    // A walk can tell them apart from real nodes without knowing the tree,
+    // so next() and prev() need only the node.
+    template <class Value, bool Ranked = false>
+    struct rb_tree_node : public rb_tree_node_size<Ranked>
     {
-        Value       value;
-        rb_tree_node*  parent;
+    private:
+        static const size_t _color_bit = 1;
+        static const size_t _header_bit = 2;
+        static const size_t _flag_bits = _color_bit | _header_bit;
+
+        size_t         _parent_color;
+
+    public:
         rb_tree_node*  left;
         rb_tree_node*  right;
-        rb_tree_color  color;
+        Value          value;
+
         rb_tree_node(const Value& v) : 
-            value(v), parent(0), left(0), right(0), color(RED) {}
+            _parent_color(0), left(0), right(0), value(v) {}
+
+        rb_tree_node* parent() const
+        {
+            return reinterpret_cast<rb_tree_node*>(_parent_color & ~_flag_bits);
+        }
+
+        rb_tree_color color() const { return static_cast<rb_tree_color>(_parent_color & _color_bit); }
+
+        void set_parent(rb_tree_node* p)
+        {
+            _parent_color = reinterpret_cast<size_t>(p) | (_parent_color & _flag_bits);
+        }
+
+        void set_color(rb_tree_color c) { _parent_color = (_parent_color & ~_color_bit) | c; }
+
+        // Sets both at once, e.g. on raw memory that was never constructed
+        void reset(rb_tree_node* p, rb_tree_color c)
+        {
+            _parent_color = reinterpret_cast<size_t>(p) | c;
+        }
+
+        bool is_header() const { return (_parent_color & _header_bit) != 0; }
+
+        void make_header() { _parent_color |= _header_bit; }
+
+        // Shared by all trees of this node type and never written once set
+        // up; like a header, its value is never constructed
+        static rb_tree_node* leaf()
+        {
+            static rb_tree_node* node = _make_leaf();
+            return node;
+        }
+
+        // In-order successor; the sentinel after the largest node
+        rb_tree_node* next() const
+        {
+            rb_tree_node* node = const_cast<rb_tree_node*>(this);
+            if (!right->is_header())
+            {
+                node = right;
+                while (!node->left->is_header())
+                    node = node->left;
+                return node;
+            }
+
+            rb_tree_node* p = node->parent();
+            while (!p->is_header() && node == p->right)
+            {
+                node = p;
+                p = p->parent();
+            }
+            return p;
+        }
+
+        // In-order predecessor; the sentinel's is the largest node, whose
+        // address it keeps in right
+        rb_tree_node* prev() const
+        {
+            rb_tree_node* node = const_cast<rb_tree_node*>(this);
+            if (is_header())
+                return right;
+            if (!left->is_header())
+            {
+                node = left;
+                while (!node->right->is_header())
+                    node = node->right;
+                return node;
+            }
+
+            rb_tree_node* p = node->parent();
+            while (!p->is_header() && node == p->left)
+            {
+                node = p;
+                p = p->parent();
+            }
+            return p;
+        }
+
+    private:
+        static rb_tree_node* _make_leaf()
+        {
+            static char storage[sizeof(rb_tree_node)] __attribute__((aligned(__alignof__(rb_tree_node))));
+            rb_tree_node* node = reinterpret_cast<rb_tree_node*>(storage);
+            node->reset(0, BLACK);
+            node->make_header();
+            node->set_subtree_size(0);
+            node->left = node;
+            node->right = node;
+            return node;
+        }
     };
 
+    template <class Value, bool Ranked>
+    const size_t rb_tree_node<Value, Ranked>::_color_bit;
+
+    template <class Value, bool Ranked>
+    const size_t rb_tree_node<Value, Ranked>::_header_bit;
+
+    template <class Value, bool Ranked>
+    const size_t rb_tree_node<Value, Ranked>::_flag_bits;
+
     // Red-Black Tree implementation
-    template <class Key, class Value, class KeyOfValue, class Compare, class Allocator>
+    // Ranked trees also keep subtree sizes (one more word per node), which
+    // makes nth(), rank() and counting equal keys O(log n)
+    template <class Key, class Value, class KeyOfValue, class Compare, class Allocator,
+              bool Ranked = false>
     class rb_tree 
     {
     public:
@@ -43,16 +195,16 @@ namespace ft
         typedef const value_type&                        const_reference;
         typedef typename Allocator::pointer              pointer;
         typedef typename Allocator::const_pointer        const_pointer;
-        typedef rb_tree_node<Value>                      node_type;
-        typedef rb_tree_node<Value>*                     node_pointer;
-        typedef const rb_tree_node<Value>*                     const_node_pointer;
+        typedef rb_tree_node<Value, Ranked>                      node_type;
+        typedef rb_tree_node<Value, Ranked>*                     node_pointer;
+        typedef const rb_tree_node<Value, Ranked>*                     const_node_pointer;
         typedef typename Allocator::template rebind<node_type>::other node_allocator_type;
     // Bidirectional iterator for Red-Black Tree
     // template <class Value, class Pointer = Value*, class Reference = Value&>
     public: 
          node_pointer minimum(node_pointer node) const
         {
-            while (node && node->left && node->left != _nil)
+            while (node && node->left && !node->left->is_header())
             {
                 node = node->left;
             }
@@ -61,77 +213,13 @@ namespace ft
 
         node_pointer maximum(node_pointer node) const
         {
-            while (node && node->right && node->right != _nil)
+            while (node && node->right && !node->right->is_header())
             {
                 node = node->right;
             }
             return node;
         }
 
-        node_pointer successor(node_pointer node) const
-        {
-            if (!node)
-                return 0;
-            if (node->right && node->right != _nil)
-                return minimum(node->right);
-
-            node_pointer parent = node->parent;
-            while (parent && parent != _nil && node == parent->right)
-            {
-                node = parent;
-                parent = parent->parent;
-            }
-            return parent;
-        }
-        
-        const_node_pointer successor(const_node_pointer node) const
-        {
-            if (!node)
-                return 0;
-            if (node->right && node->right != _nil)
-                return minimum(node->right);
-
-            node_pointer parent = node->parent;
-            while (parent && parent != _nil && node == parent->right)
-            {
-                node = parent;
-                parent = parent->parent;
-            }
-            return parent;
-        }
-        
-        node_pointer predecessor(node_pointer node) const
-        {
-            if (!node)
-                return 0;
-            if (node->left && node->left != _nil)
-                return maximum(node->left);
-
-            node_pointer parent = node->parent;
-            while (parent && parent != _nil && node == parent->left)
-            {
-                node = parent;
-                parent = parent->parent;
-            }
-            return parent;
-        }
-        
-        const_node_pointer predecessor(const_node_pointer node) const
-        {
-            if (!node)
-                return 0;
-            if (node->left && node->left != _nil)
-                return maximum(node->left);
-
-            node_pointer parent = node->parent;
-            while (parent && parent != _nil && node == parent->left)
-            {
-                node = parent;
-                parent = parent->parent;
-            }
-            return parent;
-        }
-
     private:
         node_pointer     _nil;     // Sentinel node
         node_pointer     _root;
@@ -147,21 +235,18 @@ namespace ft
         typedef Value*                        pointer;
         typedef Value&                      reference;
         typedef ptrdiff_t                      difference_type;
-        typedef rb_tree_node<Value>*           node_pointer;
+        typedef rb_tree_node<Value, Ranked>*           node_pointer;
 
     private:
         node_pointer _node;
-        
-    public:
-        rb_tree * _tree;
 
     public:
-        iterator() : _node(0), _tree(0) {}
+        iterator() : _node(0) {}
         
-        explicit iterator(node_pointer node, rb_tree *tree) : _node(node), _tree(tree) {}
+        explicit iterator(node_pointer node) : _node(node) {}
         
         // template <class V, class P, class R>
-        iterator(const iterator& other) : _node(other.base()), _tree(other._tree) {}
+        iterator(const iterator& other) : _node(other.base()) {}
 
         ~iterator() {}
 
@@ -172,7 +257,7 @@ namespace ft
 
         iterator& operator++() 
         {
-            _node = _tree->successor(_node);
+            _node = _node->next();
             return *this;
         }
 
@@ -185,7 +270,7 @@ namespace ft
 
         iterator& operator--() 
         {
-            _node = _tree->predecessor(_node);
+            _node = _node->prev();
             return *this;
         }
 
@@ -215,18 +300,17 @@ namespace ft
         typedef const Value*                      pointer;
         typedef const Value&                      reference;
         typedef ptrdiff_t                      difference_type;
-        typedef const rb_tree_node<Value>*     node_pointer;
+        typedef const rb_tree_node<Value, Ranked>*     node_pointer;
 
     private:
         node_pointer _node;
-        const rb_tree *_tree;
 
     public:
-        const_iterator() : _node(0), _tree(0) {}
+        const_iterator() : _node(0) {}
         
-        explicit const_iterator(node_pointer node, const rb_tree *tree) : _node(node), _tree(tree) {}
+        explicit const_iterator(node_pointer node) : _node(node) {}
         
-        const_iterator(const iterator& other) : _node(other.base()), _tree(other._tree) {}
+        const_iterator(const iterator& other) : _node(other.base()) {}
 
         ~const_iterator() {}
 
@@ -237,7 +321,7 @@ namespace ft
 
         const_iterator& operator++() 
         {
-            _node = _tree->successor(_node);
+            _node = _node->next();
             return *this;
         }
 
@@ -250,7 +334,7 @@ namespace ft
 
         const_iterator& operator--() 
         {
-            _node = _tree->predecessor(_node);
+            _node = _node->prev();
             return *this;
         }
 
@@ -274,306 +358,1268 @@ namespace ft
         typedef ft::reverse_iterator<iterator>           reverse_iterator;
         typedef ft::reverse_iterator<const_iterator>     const_reverse_iterator;
 
+    // Owns a node that extract() took out of a tree, value included, until
+    // insert() links it into a tree again; a handle dropped while still
+    // holding one destroys and frees it. There is no move in C++98, so a
+    // copy takes the node over like std::auto_ptr does and leaves the
+    // source empty; that lets a handle be returned and passed by value.
+    class node_handle
+    {
+    public:
+        typedef Key       key_type;
+        typedef Value     value_type;
+        typedef Allocator allocator_type;
+
+    private:
+        mutable node_pointer _node;
+        node_allocator_type  _alloc;
+
+        friend class rb_tree;
+
+        node_handle(node_pointer node, const node_allocator_type& alloc) : _node(node), _alloc(alloc) {}
+
+        node_pointer _release() const
+        {
+            node_pointer node = _node;
+            _node = 0;
+            return node;
+        }
+
+        void _reset()
+        {
+            if (!_node)
+                return;
+            _alloc.destroy(_node);
+            _alloc.deallocate(_node, 1);
+            _node = 0;
+        }
+
+    public:
+        node_handle() : _node(0), _alloc() {}
+
+        node_handle(const node_handle& other) : _node(other._release()), _alloc(other._alloc) {}
+
+        ~node_handle() { _reset(); }
+
+        node_handle& operator=(const node_handle& other)
+        {
+            if (this != &other)
+            {
+                _reset();
+                _alloc = other._alloc;
+                _node = other._release();
+            }
+            return *this;
+        }
+
+        bool empty() const { return _node == 0; }
+
+        value_type& value() const { return _node->value; }
+
+        // Writable, so that an element can be given a new key between
+        // extract() and insert()
+        key_type& key() const
+        {
+            return const_cast<key_type&>(KeyOfValue()(static_cast<const value_type&>(_node->value)));
+        }
+
+        allocator_type get_allocator() const { return _alloc; }
+
+        void swap(node_handle& other)
+        {
+            ft::swap(_node, other._node);
+            ft::swap(_alloc, other._alloc);
+        }
+    };
+
     
 
     
     private:
+        // _nil is the header: end(), the root's parent, and through its left
+        // and right the smallest and largest node (_nil itself when empty),
+        // which keeps begin() and --end() O(1). Child links without a node
+        // point to the shared _leaf() instead, so a subtree can move to
+        // another tree without touching its leaves.
+        static node_pointer _leaf() { return node_type::leaf(); }
+
+        node_pointer& _leftmost() const { return _nil->left; }
+        node_pointer& _rightmost() const { return _nil->right; }
+
+        void _reset_extremes()
+        {
+            _leftmost() = _root->is_header() ? _nil : minimum(_root);
+            _rightmost() = _root->is_header() ? _nil : maximum(_root);
+        }
+
         void _create_nil() 
         {
             _nil = _node_alloc.allocate(1);
             // Do not construct value for _nil to avoid unnecessary default construction
-            _nil->color = BLACK;
+            _nil->reset(_nil, BLACK);
+            _nil->make_header();
+            _nil->set_subtree_size(0);
             _nil->left = _nil;
             _nil->right = _nil;
-            _nil->parent = _nil;
             _root = _nil;
         }
 
         void _left_rotate(node_pointer x) 
         {
-            if (!x || x == _nil) return;
+            if (!x || x->is_header()) return;
             node_pointer y = x->right;
-            if (!y || y == _nil) return;
+            if (!y || y->is_header()) return;
             
             x->right = y->left;
-            if (y->left != _nil)
-                y->left->parent = x;
+            if (!y->left->is_header())
+                y->left->set_parent(x);
             
-            y->parent = x->parent;
-            if (x->parent == _nil)
+            y->set_parent(x->parent());
+            if (x->parent()->is_header())
                 _root = y;
-            else if (x == x->parent->left)
-                x->parent->left = y;
+            else if (x == x->parent()->left)
+                x->parent()->left = y;
             else
-                x->parent->right = y;
+                x->parent()->right = y;
             
             y->left = x;
-            x->parent = y;
+            x->set_parent(y);
+
+            if (Ranked)
+            {
+                y->set_subtree_size(x->subtree_size());
+                x->set_subtree_size(x->left->subtree_size() + x->right->subtree_size() + 1);
+            }
         }
 
         void _right_rotate(node_pointer y) 
         {
-            if (!y || y == _nil) return;
+            if (!y || y->is_header()) return;
             node_pointer x = y->left;
-            if (!x || x == _nil) return;
+            if (!x || x->is_header()) return;
             
             y->left = x->right;
-            if (x->right != _nil)
-                x->right->parent = y;
+            if (!x->right->is_header())
+                x->right->set_parent(y);
             
-            x->parent = y->parent;
-            if (y->parent == _nil)
+            x->set_parent(y->parent());
+            if (y->parent()->is_header())
                 _root = x;
-            else if (y == y->parent->left)
-                y->parent->left = x;
+            else if (y == y->parent()->left)
+                y->parent()->left = x;
             else
-                y->parent->right = x;
+                y->parent()->right = x;
             
             x->right = y;
-            y->parent = x;
+            y->set_parent(x);
+
+            if (Ranked)
+            {
+                x->set_subtree_size(y->subtree_size());
+                y->set_subtree_size(y->left->subtree_size() + y->right->subtree_size() + 1);
+            }
         }
         
-        void _insert_fixup(node_pointer z) 
+        // Returns true when it had to blacken a red root, which adds one to
+        // the black height of the whole tree
+        bool _insert_fixup(node_pointer z) 
        {
-           if (!z || z == _nil) return;
+           if (!z || z->is_header()) return false;
            
-           while (z != _root && z->parent != _nil && z->parent->color == RED) 
+           while (z != _root && !z->parent()->is_header() && z->parent()->color() == RED) 
            {
-               if (z->parent->parent == _nil) break;
+               if (z->parent()->parent()->is_header()) break;
                
-               if (z->parent == z->parent->parent->left) 
+               if (z->parent() == z->parent()->parent()->left) 
                {
-                   node_pointer y = z->parent->parent->right;
+                   node_pointer y = z->parent()->parent()->right;
                    
-                   if (y != _nil && y->color == RED) 
+                   if (!y->is_header() && y->color() == RED) 
                    {
-                       z->parent->color = BLACK;
-                       y->color = BLACK;
-                       z->parent->parent->color = RED;
-                       z = z->parent->parent;
+                       z->parent()->set_color(BLACK);
+                       y->set_color(BLACK);
+                       z->parent()->parent()->set_color(RED);
+                       z = z->parent()->parent();
                    } 
                    else 
                    {
-                       if (z == z->parent->right) 
+                       if (z == z->parent()->right) 
                        {
-                           z = z->parent;
+                           z = z->parent();
                            _left_rotate(z);
                        }
-                       z->parent->color = BLACK;
-                       if (z->parent->parent != _nil) 
+                       z->parent()->set_color(BLACK);
+                       if (!z->parent()->parent()->is_header()) 
                        {
-                           z->parent->parent->color = RED;
-                           _right_rotate(z->parent->parent);
+                           z->parent()->parent()->set_color(RED);
+                           _right_rotate(z->parent()->parent());
                        }
                    }
                } 
                else 
                {
                    // Same logic for the right case
-                   node_pointer y = z->parent->parent->left;
+                   node_pointer y = z->parent()->parent()->left;
                    
-                   if (y != _nil && y->color == RED) 
+                   if (!y->is_header() && y->color() == RED) 
                    {
-                       z->parent->color = BLACK;
-                       y->color = BLACK;
-                       z->parent->parent->color = RED;
-                       z = z->parent->parent;
+                       z->parent()->set_color(BLACK);
+                       y->set_color(BLACK);
+                       z->parent()->parent()->set_color(RED);
+                       z = z->parent()->parent();
                    } 
                    else 
                    {
-                       if (z == z->parent->left) 
+                       if (z == z->parent()->left) 
                        {
-                           z = z->parent;
+                           z = z->parent();
                            _right_rotate(z);
                        }
-                       z->parent->color = BLACK;
-                       if (z->parent->parent != _nil) 
+                       z->parent()->set_color(BLACK);
+                       if (!z->parent()->parent()->is_header()) 
                        {
-                           z->parent->parent->color = RED;
-                           _left_rotate(z->parent->parent);
+                           z->parent()->parent()->set_color(RED);
+                           _left_rotate(z->parent()->parent());
                        }
                    }
                }
            }
-           _root->color = BLACK;
+           bool grew = _root->color() == RED;
+           _root->set_color(BLACK);
+           return grew;
        }
 
-        node_pointer _find(const key_type& k) const 
+        // One comparison per level: the last node k did not sort before is
+        // the only one that can be equal to it, and is checked once at the end.
+        // The lookups take any K the comparator accepts, see find(const K&).
+        template <class K>
+        node_pointer _find(const K& k) const 
         {
             node_pointer current = _root;
-            
-            while (current != _nil) 
+            node_pointer candidate = _nil;
+
+            while (!current->is_header()) 
             {
-                if (!_comp(KeyOfValue()(current->value), k) && 
-                    !_comp(k, KeyOfValue()(current->value)))
-                    return current;
-                current = _comp(k, KeyOfValue()(current->value)) ? 
-                         current->left : current->right;
+                if (_comp(k, KeyOfValue()(current->value)))
+                    current = current->left;
+                else
+                {
+                    candidate = current;
+                    current = current->right;
+                }
             }
+            if (!candidate->is_header() && !_comp(KeyOfValue()(candidate->value), k))
+                return candidate;
             return _nil;
         }
 
-        ft::pair<node_pointer, bool> _find_position(const key_type& k) const 
+        // Same descent as _find, but also remembers where k would be linked.
+        // Returns the node holding k and false, or the parent to link under
+        // and true, with left telling which side.
+        ft::pair<node_pointer, bool> _find_position(const key_type& k, bool& left) const 
         {
             node_pointer current = _root;
             node_pointer parent = _nil;
-            bool is_left = true;
-            
-            while (current != _nil) 
+            node_pointer candidate = _nil;
+
+            left = true;
+            while (!current->is_header()) 
             {
                 parent = current;
-                if (!_comp(KeyOfValue()(current->value), k) && 
-                    !_comp(k, KeyOfValue()(current->value)))
-                    return ft::make_pair(current, false);
-                is_left = _comp(k, KeyOfValue()(current->value));
-                current = is_left ? current->left : current->right;
+                left = _comp(k, KeyOfValue()(current->value));
+                if (left)
+                    current = current->left;
+                else
+                {
+                    candidate = current;
+                    current = current->right;
+                }
             }
+            if (!candidate->is_header() && !_comp(KeyOfValue()(candidate->value), k))
+                return ft::make_pair(candidate, false);
             return ft::make_pair(parent, true);
         }
 
-
-        void _erase_fixup(node_pointer x, node_pointer x_parent) 
+        // Creates a node for value as the left or right child of parent,
+        // whose slot on that side must be empty, and rebalances
+        node_pointer _link(node_pointer parent, bool left, const value_type& value)
         {
-            while (x != _root && (x == _nil || x->color == BLACK)) 
+            node_pointer new_node = _node_alloc.allocate(1);
+            try
             {
-                if (!x_parent || x_parent == _nil) break;
-
-                if (x == x_parent->left) 
-                {
-                    node_pointer w = x_parent->right;
-                    if (!w || w == _nil) break;
-
-                    if (w->color == RED) 
-                    {
-                        w->color = BLACK;
-                        x_parent->color = RED;
-                        _left_rotate(x_parent);
-                        w = x_parent->right;
-                        if (!w || w == _nil) break;
-                    }
+                _node_alloc.construct(new_node, value);
+            }
+            catch (...)
+            {
+                _node_alloc.deallocate(new_node, 1);
+                throw;
+            }
+            return _link_node(parent, left, new_node);
+        }
 
-                    bool left_black = (w->left == _nil || w->left->color == BLACK);
-                    bool right_black = (w->right == _nil || w->right->color == BLACK);
+        // Same for a node that is already built, fresh or unlinked from a
+        // tree with the same allocator
+        node_pointer _link_node(node_pointer parent, bool left, node_pointer new_node)
+        {
+            new_node->reset(parent, RED);
+            new_node->left = _leaf();
+            new_node->right = _leaf();
+            new_node->set_subtree_size(1);
 
-                    if (left_black && right_black) 
-                    {
-                        w->color = RED;
-                        x = x_parent;
-                        x_parent = x->parent;
-                    } 
-                    else 
-                    {
-                        if (right_black) 
-                        {
-                            if (w->left != _nil)
-                                w->left->color = BLACK;
-                            w->color = RED;
-                            _right_rotate(w);
-                            w = x_parent->right;
-                            if (!w || w == _nil) break;
-                        }
-                        w->color = x_parent->color;
-                        x_parent->color = BLACK;
-                        if (w->right != _nil)
-                            w->right->color = BLACK;
-                        _left_rotate(x_parent);
-                        x = _root;
-                    }
-                } 
-                else 
-                {
-                    // Same logic for the right case with left/right swapped
-                    node_pointer w = x_parent->left;
-                    if (!w || w == _nil) break;
+            if (parent->is_header())
+            {
+                _root = new_node;
+                _leftmost() = new_node;
+                _rightmost() = new_node;
+            }
+            else if (left)
+            {
+                parent->left = new_node;
+                if (parent == _leftmost())
+                    _leftmost() = new_node;
+            }
+            else
+            {
+                parent->right = new_node;
+                if (parent == _rightmost())
+                    _rightmost() = new_node;
+            }
 
-                    if (w->color == RED) 
-                    {
-                        w->color = BLACK;
-                        x_parent->color = RED;
-                        _right_rotate(x_parent);
-                        w = x_parent->left;
-                        if (!w || w == _nil) break;
-                    }
+            if (Ranked)
+                _adjust_sizes(parent, true);
+            _insert_fixup(new_node);
+            ++_size;
+            return new_node;
+        }
 
-                    bool right_black = (w->right == _nil || w->right->color == BLACK);
-                    bool left_black = (w->left == _nil || w->left->color == BLACK);
+        node_pointer _nth(size_type k) const
+        {
+            if (k >= _size)
+                return _nil;
+            if (!Ranked)
+            {
+                node_pointer node = _leftmost();
+                while (k--)
+                    node = node->next();
+                return node;
+            }
 
-                    if (right_black && left_black) 
-                    {
-                        w->color = RED;
-                        x = x_parent;
-                        x_parent = x->parent;
-                    } 
-                    else 
-                    {
-                        if (left_black) 
-                        {
-                            if (w->right != _nil)
-                                w->right->color = BLACK;
-                            w->color = RED;
-                            _left_rotate(w);
-                            w = x_parent->left;
-                            if (!w || w == _nil) break;
-                        }
-                        w->color = x_parent->color;
-                        x_parent->color = BLACK;
-                        if (w->left != _nil)
-                            w->left->color = BLACK;
-                        _right_rotate(x_parent);
-                        x = _root;
-                    }
+            node_pointer node = _root;
+            while (true)
+            {
+                size_type left = node->left->subtree_size();
+                if (k == left)
+                    return node;
+                if (k < left)
+                    node = node->left;
+                else
+                {
+                    k -= left + 1;
+                    node = node->right;
                 }
             }
-
-            if (x != _nil && x != NULL)
-                x->color = BLACK;
         }
 
-        void _transplant(node_pointer u, node_pointer v) 
+        // First node whose key is not before k; _nil if none
+        template <class K>
+        node_pointer _lower_bound(const K& k) const
         {
-            if (!u || u == _nil) return;
-            
-            // Make sure v is _nil if null
-            if (v == NULL) v = _nil;
-            
-            if (u->parent == _nil)
-                _root = v;
-            else if (u == u->parent->left)
-                u->parent->left = v;
-            else
-                u->parent->right = v;
-            
-            v->parent = u->parent;  // Always update parent, even for _nil
-        }
+            node_pointer current = _root;
+            node_pointer result = _nil;
 
-        void _clear_recursive(node_pointer node) 
-        {
-            if (node == _nil || !node)
-                return;
-            
-            _clear_recursive(node->left);
-            _clear_recursive(node->right);
-            
-            _node_alloc.destroy(node);
-            _node_alloc.deallocate(node, 1);
+            while (!current->is_header())
+            {
+                if (!_comp(KeyOfValue()(current->value), k))
+                {
+                    result = current;
+                    current = current->left;
+                }
+                else
+                    current = current->right;
+            }
+            return result;
         }
 
-        node_pointer _copy_recursive(node_pointer src, node_pointer parent) 
+        // First node whose key is after k; _nil if none
+        template <class K>
+        node_pointer _upper_bound(const K& k) const
         {
-            if (!src || src == _nil)
-                return _nil;
+            node_pointer current = _root;
+            node_pointer result = _nil;
+
+            while (!current->is_header())
+            {
+                if (_comp(k, KeyOfValue()(current->value)))
+                {
+                    result = current;
+                    current = current->left;
+                }
+                else
+                    current = current->right;
+            }
+            return result;
+        }
+
+        // Number of elements whose key is before k, or not after k when upper
+        template <class K>
+        size_type _rank(const K& k, bool upper) const
+        {
+            if (!Ranked)
+            {
+                const_iterator bound(upper ? _upper_bound(k) : _lower_bound(k));
+                return static_cast<size_type>(ft::distance(begin(), bound));
+            }
+
+            size_type rank = 0;
+            node_pointer node = _root;
+            while (!node->is_header())
+            {
+                bool before = upper ? !_comp(k, KeyOfValue()(node->value))
+                                    : _comp(KeyOfValue()(node->value), k);
+                if (before)
+                {
+                    rank += node->left->subtree_size() + 1;
+                    node = node->right;
+                }
+                else
+                    node = node->left;
+            }
+            return rank;
+        }
+
+        // Black height of a subtree, or -1 if it breaks an invariant;
+        // count grows by the number of nodes in it
+        int _verify_subtree(const_node_pointer node, size_type& count) const
+        {
+            if (node->is_header())
+                return node == _leaf() ? 0 : -1;
+
+            const_node_pointer children[2] = { node->left, node->right };
+            for (int i = 0; i < 2; ++i)
+            {
+                if (children[i]->is_header())
+                    continue;
+                if (children[i]->parent() != node)
+                    return -1;
+                if (node->color() == RED && children[i]->color() == RED)
+                    return -1;
+            }
+
+            size_type before = count;
+            int left = _verify_subtree(node->left, count);
+            int right = _verify_subtree(node->right, count);
+            ++count;
+            if (left < 0 || left != right)
+                return -1;
+            if (Ranked && node->subtree_size() != count - before)
+                return -1;
+            return left + (node->color() == BLACK ? 1 : 0);
+        }
+
+        // Black nodes on every path from node down to a leaf
+        static size_type _black_height(node_pointer node)
+        {
+            size_type height = 0;
+            for (; !node->is_header(); node = node->left)
+            {
+                if (node->color() == BLACK)
+                    ++height;
+            }
+            return height;
+        }
+
+        // Turns a subtree into a standalone tree under _nil with a black
+        // root; a header stands for the empty tree and becomes the leaf
+        void _detach(node_pointer& node, size_type& height)
+        {
+            if (node->is_header())
+            {
+                node = _leaf();
+                return;
+            }
+            node->set_parent(_nil);
+            if (node->color() == RED)
+            {
+                node->set_color(BLACK);
+                ++height;
+            }
+        }
+
+        // Joins the trees rooted at left and right, of black heights
+        // left_height and right_height, with mid between them: every key
+        // under left orders before mid's and mid's before every key under
+        // right. mid goes on the taller tree's inner spine at the black
+        // node as high as the shorter tree, so the cost is the height
+        // difference plus the fixup. Returns the root, parented to _nil,
+        // and its black height.
+        node_pointer _join(node_pointer left, size_type left_height, node_pointer mid,
+                           node_pointer right, size_type right_height, size_type& height)
+        {
+            _detach(left, left_height);
+            _detach(right, right_height);
+
+            if (left_height == right_height)
+            {
+                mid->left = left;
+                mid->right = right;
+                if (!left->is_header())
+                    left->set_parent(mid);
+                if (!right->is_header())
+                    right->set_parent(mid);
+                mid->reset(_nil, BLACK);
+                mid->set_subtree_size(left->subtree_size() + right->subtree_size() + 1);
+                height = left_height + 1;
+                return mid;
+            }
+
+            bool left_taller = left_height > right_height;
+            node_pointer shorter = left_taller ? right : left;
+            size_type target = left_taller ? right_height : left_height;
+            size_type h = left_taller ? left_height : right_height;
+            node_pointer parent = _nil;
+            node_pointer spot = left_taller ? left : right;
+
+            while (h != target || spot->color() != BLACK)
+            {
+                if (spot->color() == BLACK)
+                    --h;
+                parent = spot;
+                spot = left_taller ? spot->right : spot->left;
+            }
+
+            mid->reset(parent, RED);
+            if (left_taller)
+            {
+                parent->right = mid;
+                mid->left = spot;
+                mid->right = shorter;
+            }
+            else
+            {
+                parent->left = mid;
+                mid->left = shorter;
+                mid->right = spot;
+            }
+            if (!spot->is_header())
+                spot->set_parent(mid);
+            if (!shorter->is_header())
+                shorter->set_parent(mid);
+            mid->set_subtree_size(spot->subtree_size() + shorter->subtree_size() + 1);
+            if (Ranked)
+            {
+                for (node_pointer node = parent; !node->is_header(); node = node->parent())
+                    node->set_subtree_size(node->subtree_size() + shorter->subtree_size() + 1);
+            }
+
+            _root = left_taller ? left : right;
+            height = (left_taller ? left_height : right_height) + (_insert_fixup(mid) ? 1 : 0);
+            return _root;
+        }
+
+        // Splits the subtree at node, of black height height, into a tree
+        // of the keys ordered before k and a tree of the rest. The joins on
+        // the way back up cost the differences between consecutive black
+        // heights, which add up to O(log n).
+        void _split(node_pointer node, size_type height, const key_type& k,
+                    node_pointer& left, size_type& left_height,
+                    node_pointer& right, size_type& right_height)
+        {
+            if (node->is_header())
+            {
+                left = _leaf();
+                right = _leaf();
+                left_height = 0;
+                right_height = 0;
+                return;
+            }
+
+            size_type child_height = node->color() == BLACK ? height - 1 : height;
+            node_pointer node_left = node->left;
+            node_pointer node_right = node->right;
+
+            if (_comp(KeyOfValue()(node->value), k))
+            {
+                _split(node_right, child_height, k, left, left_height, right, right_height);
+                left = _join(node_left, child_height, node, left, left_height, left_height);
+            }
+            else
+            {
+                _split(node_left, child_height, k, left, left_height, right, right_height);
+                right = _join(right, right_height, node, node_right, child_height, right_height);
+            }
+        }
+
+        // Like _split, but on a unique tree the node with key k, if any,
+        // is taken out into mid instead of going right; mid is 0 otherwise
+        void _split_at(node_pointer node, size_type height, const key_type& k,
+                       node_pointer& left, size_type& left_height, node_pointer& mid,
+                       node_pointer& right, size_type& right_height)
+        {
+            if (node->is_header())
+            {
+                left = _leaf();
+                right = _leaf();
+                left_height = 0;
+                right_height = 0;
+                mid = 0;
+                return;
+            }
+
+            size_type child_height = node->color() == BLACK ? height - 1 : height;
+            node_pointer node_left = node->left;
+            node_pointer node_right = node->right;
+
+            if (_comp(KeyOfValue()(node->value), k))
+            {
+                _split_at(node_right, child_height, k, left, left_height, mid, right, right_height);
+                left = _join(node_left, child_height, node, left, left_height, left_height);
+            }
+            else if (_comp(k, KeyOfValue()(node->value)))
+            {
+                _split_at(node_left, child_height, k, left, left_height, mid, right, right_height);
+                right = _join(right, right_height, node, node_right, child_height, right_height);
+            }
+            else
+            {
+                left = node_left;
+                right = node_right;
+                left_height = child_height;
+                right_height = child_height;
+                mid = node;
+            }
+        }
+
+        // _join without a middle node: right's first node takes its place
+        node_pointer _join_pair(node_pointer left, size_type left_height,
+                                node_pointer right, size_type right_height, size_type& height)
+        {
+            if (right->is_header())
+            {
+                _detach(left, left_height);
+                height = left_height;
+                return left;
+            }
+
+            node_pointer first = minimum(right);
+            node_pointer rest;
+            node_pointer none;
+            size_type none_height;
+            _split_at(right, right_height, KeyOfValue()(first->value), none, none_height, first, rest, right_height);
+            return _join(left, left_height, first, rest, right_height, height);
+        }
+
+        // Divide and conquer for unite, intersect and subtract: split the
+        // subtree at root around the key at other, recurse on the halves
+        // with other's children and join the results. Recursion stops as
+        // soon as either side is empty, so with m the smaller size and n
+        // the larger the work is O(m log(n/m + 1)). _unite owns other:
+        // its nodes are linked in or freed.
+        node_pointer _unite(node_pointer root, size_type height, node_pointer other,
+                            size_type other_height, size_type& dropped, size_type& out_height)
+        {
+            if (other->is_header())
+            {
+                out_height = height;
+                return root;
+            }
+            if (root->is_header())
+            {
+                out_height = other_height;
+                return other;
+            }
+
+            size_type child_height = other->color() == BLACK ? other_height - 1 : other_height;
+            node_pointer other_left = other->left;
+            node_pointer other_right = other->right;
+            node_pointer left;
+            node_pointer mid;
+            node_pointer right;
+            size_type left_height;
+            size_type right_height;
+            _split_at(root, height, KeyOfValue()(other->value), left, left_height, mid, right, right_height);
+
+            left = _unite(left, left_height, other_left, child_height, dropped, left_height);
+            right = _unite(right, right_height, other_right, child_height, dropped, right_height);
+            if (mid)
+            {
+                _node_alloc.destroy(other);
+                _node_alloc.deallocate(other, 1);
+                ++dropped;
+            }
+            else
+                mid = other;
+            return _join(left, left_height, mid, right, right_height, out_height);
+        }
+
+        node_pointer _intersect(node_pointer root, size_type height, const_node_pointer other,
+                                size_type& kept, size_type& out_height)
+        {
+            if (root->is_header() || other->is_header())
+            {
+                _clear_recursive(root);
+                out_height = 0;
+                return _leaf();
+            }
+
+            node_pointer left;
+            node_pointer mid;
+            node_pointer right;
+            size_type left_height;
+            size_type right_height;
+            _split_at(root, height, KeyOfValue()(other->value), left, left_height, mid, right, right_height);
+
+            left = _intersect(left, left_height, other->left, kept, left_height);
+            right = _intersect(right, right_height, other->right, kept, right_height);
+            if (!mid)
+                return _join_pair(left, left_height, right, right_height, out_height);
+            ++kept;
+            return _join(left, left_height, mid, right, right_height, out_height);
+        }
+
+        node_pointer _subtract(node_pointer root, size_type height, const_node_pointer other,
+                               size_type& removed, size_type& out_height)
+        {
+            if (root->is_header() || other->is_header())
+            {
+                out_height = height;
+                return root;
+            }
+
+            node_pointer left;
+            node_pointer mid;
+            node_pointer right;
+            size_type left_height;
+            size_type right_height;
+            _split_at(root, height, KeyOfValue()(other->value), left, left_height, mid, right, right_height);
+
+            left = _subtract(left, left_height, other->left, removed, left_height);
+            right = _subtract(right, right_height, other->right, removed, right_height);
+            if (mid)
+            {
+                _node_alloc.destroy(mid);
+                _node_alloc.deallocate(mid, 1);
+                ++removed;
+            }
+            return _join_pair(left, left_height, right, right_height, out_height);
+        }
+
+        // Takes over a tree built by _join or _split
+        void _adopt(node_pointer root, size_type size)
+        {
+            _root = root->is_header() ? _nil : root;
+            if (!_root->is_header())
+                _root->reset(_nil, BLACK);
+            _size = size;
+            _reset_extremes();
+        }
+
+        // Gives an empty tree the comparator and the allocator of other, so
+        // that nodes can move between the two
+        void _share_policies(const rb_tree& other)
+        {
+            _comp = other._comp;
+            if (_node_alloc == other._node_alloc)
+                return;
+            _node_alloc.deallocate(_nil, 1);
+            _nil = 0;
+            _node_alloc = other._node_alloc;
+            _create_nil();
+        }
+
+        void _join_trees(rb_tree& other, bool unique)
+        {
+            if (&other == this || other._size == 0)
+                return;
+
+            if (_size)
+            {
+                const key_type& first = KeyOfValue()(_leftmost()->value);
+                const key_type& last = KeyOfValue()(_rightmost()->value);
+                const key_type& other_first = KeyOfValue()(other._leftmost()->value);
+                const key_type& other_last = KeyOfValue()(other._rightmost()->value);
+                bool after = unique ? _comp(last, other_first) : !_comp(other_first, last);
+                bool before = unique ? _comp(other_last, first) : !_comp(first, other_last);
+                if (!after && !before)
+                    throw std::invalid_argument("rb_tree::join: key ranges overlap");
+            }
+
+            if (!(_node_alloc == other._node_alloc))
+            {
+                // Nodes cannot change allocators; copy them over instead
+                _insert_range(other.begin(), other.end(), unique, std::forward_iterator_tag());
+                other.clear();
+                return;
+            }
+
+            if (_size == 0)
+            {
+                _adopt(other._root, other._size);
+                other._root = other._nil;
+                other._size = 0;
+                other._reset_extremes();
+                return;
+            }
+
+            bool after = !_comp(KeyOfValue()(other._leftmost()->value), KeyOfValue()(_rightmost()->value));
+            node_pointer mid = after ? other._leftmost() : other._rightmost();
+            other._unlink(mid);
+
+            size_type size = _size + other._size + 1;
+            size_type height;
+            node_pointer root;
+            if (after)
+                root = _join(_root, _black_height(_root), mid, other._root, _black_height(other._root), height);
+            else
+                root = _join(other._root, _black_height(other._root), mid, _root, _black_height(_root), height);
+
+            other._root = other._nil;
+            other._size = 0;
+            other._reset_extremes();
+            _adopt(root, size);
+        }
+
+        // Where insert_multi links k: after every key equal to it
+        node_pointer _multi_parent(const key_type& k, bool& left) const
+        {
+            node_pointer parent = _nil;
+            node_pointer current = _root;
+
+            left = true;
+            while (!current->is_header())
+            {
+                parent = current;
+                left = _comp(k, KeyOfValue()(current->value));
+                current = left ? current->left : current->right;
+            }
+            return parent;
+        }
+
+        // Links the node nh holds, or a copy of its value if nh's allocator
+        // cannot free nodes of this tree, and empties nh
+        node_pointer _link_handle(node_pointer parent, bool left, const node_handle& nh)
+        {
+            if (nh._alloc == _node_alloc)
+                return _link_node(parent, left, nh._release());
+
+            node_pointer node = _link(parent, left, nh.value());
+            node_allocator_type alloc(nh._alloc);
+            node_pointer old = nh._release();
+            alloc.destroy(old);
+            alloc.deallocate(old, 1);
+            return node;
+        }
+
+        // Moves the nodes of other over one by one, O(m log(n + m)), and in
+        // O(log(n + m)) through _join_trees when the key ranges do not
+        // overlap. With unique keys, the nodes whose key is already present
+        // stay in other; equal keys otherwise go after the ones here.
+        void _merge(rb_tree& other, bool unique)
+        {
+            if (&other == this || other._size == 0)
+                return;
+
+            if (_size == 0 || _node_alloc == other._node_alloc)
+            {
+                bool disjoint = _size == 0;
+                if (!disjoint)
+                {
+                    const key_type& first = KeyOfValue()(_leftmost()->value);
+                    const key_type& last = KeyOfValue()(_rightmost()->value);
+                    disjoint = _comp(KeyOfValue()(other._rightmost()->value), first)
+                               || (unique ? _comp(last, KeyOfValue()(other._leftmost()->value))
+                                          : !_comp(KeyOfValue()(other._leftmost()->value), last));
+                }
+                if (disjoint)
+                {
+                    _join_trees(other, unique);
+                    return;
+                }
+            }
+
+            bool same_alloc = _node_alloc == other._node_alloc;
+            for (iterator it = other.begin(); it != other.end(); )
+            {
+                node_pointer node = (it++).base();
+                const key_type& k = KeyOfValue()(node->value);
+                bool left;
+                node_pointer parent;
+                if (unique)
+                {
+                    ft::pair<node_pointer, bool> pos = _find_position(k, left);
+                    if (!pos.second)
+                        continue;
+                    parent = pos.first;
+                }
+                else
+                    parent = _multi_parent(k, left);
+
+                if (same_alloc)
+                {
+                    other._unlink(node);
+                    _link_node(parent, left, node);
+                }
+                else
+                {
+                    _link(parent, left, node->value);
+                    other.erase(iterator(node));
+                }
+            }
+        }
+
+        // Takes z out of the tree and rebalances, without freeing it
+        void _unlink(node_pointer z)
+        {
+            if (z == _leftmost())
+                _leftmost() = z->next();
+            if (z == _rightmost())
+                _rightmost() = z->prev();
+
+            node_pointer y = z;
+            node_pointer x;
+            node_pointer x_parent;
+            rb_tree_color y_original_color = y->color();
+
+            // The node that leaves its place is z itself, or z's successor
+            // when z has two children
+            if (Ranked)
+                _adjust_sizes(z->left->is_header() || z->right->is_header() ? z->parent() : minimum(z->right)->parent(), false);
+
+            // Leaves are shared and never written, so x_parent is tracked
+            // here instead of through x->parent()
+            if (z->left->is_header())
+            {
+                x = z->right;
+                x_parent = z->parent();
+                _transplant(z, z->right);
+            }
+            else if (z->right->is_header())
+            {
+                x = z->left;
+                x_parent = z->parent();
+                _transplant(z, z->left);
+            }
+            else
+            {
+                y = minimum(z->right);
+                y_original_color = y->color();
+                x = y->right;
+
+                if (y->parent() == z)
+                    x_parent = y;
+                else
+                {
+                    x_parent = y->parent();
+                    _transplant(y, y->right);
+                    y->right = z->right;
+                    y->right->set_parent(y);
+                }
+
+                _transplant(z, y);
+                y->left = z->left;
+                y->left->set_parent(y);
+                y->set_color(z->color());
+                y->set_subtree_size(z->subtree_size());
+            }
+
+            if (y_original_color == BLACK)
+                _erase_fixup(x, x_parent);
+
+            --_size;
+        }
+
+        // Ranked trees: one element more or less under every node from
+        // node up to the root
+        void _adjust_sizes(node_pointer node, bool grow)
+        {
+            for (; !node->is_header(); node = node->parent())
+            {
+                if (grow)
+                    node->set_subtree_size(node->subtree_size() + 1);
+                else
+                    node->set_subtree_size(node->subtree_size() - 1);
+            }
+        }
+
+        void _erase_fixup(node_pointer x, node_pointer x_parent) 
+        {
+            while (x != _root && (x->is_header() || x->color() == BLACK)) 
+            {
+                if (!x_parent || x_parent->is_header()) break;
+
+                if (x == x_parent->left) 
+                {
+                    node_pointer w = x_parent->right;
+                    if (!w || w->is_header()) break;
+
+                    if (w->color() == RED) 
+                    {
+                        w->set_color(BLACK);
+                        x_parent->set_color(RED);
+                        _left_rotate(x_parent);
+                        w = x_parent->right;
+                        if (!w || w->is_header()) break;
+                    }
+
+                    bool left_black = (w->left->is_header() || w->left->color() == BLACK);
+                    bool right_black = (w->right->is_header() || w->right->color() == BLACK);
+
+                    if (left_black && right_black) 
+                    {
+                        w->set_color(RED);
+                        x = x_parent;
+                        x_parent = x->parent();
+                    } 
+                    else 
+                    {
+                        if (right_black) 
+                        {
+                            if (!w->left->is_header())
+                                w->left->set_color(BLACK);
+                            w->set_color(RED);
+                            _right_rotate(w);
+                            w = x_parent->right;
+                            if (!w || w->is_header()) break;
+                        }
+                        w->set_color(x_parent->color());
+                        x_parent->set_color(BLACK);
+                        if (!w->right->is_header())
+                            w->right->set_color(BLACK);
+                        _left_rotate(x_parent);
+                        x = _root;
+                    }
+                } 
+                else 
+                {
+                    // Same logic for the right case with left/right swapped
+                    node_pointer w = x_parent->left;
+                    if (!w || w->is_header()) break;
+
+                    if (w->color() == RED) 
+                    {
+                        w->set_color(BLACK);
+                        x_parent->set_color(RED);
+                        _right_rotate(x_parent);
+                        w = x_parent->left;
+                        if (!w || w->is_header()) break;
+                    }
+
+                    bool right_black = (w->right->is_header() || w->right->color() == BLACK);
+                    bool left_black = (w->left->is_header() || w->left->color() == BLACK);
+
+                    if (right_black && left_black) 
+                    {
+                        w->set_color(RED);
+                        x = x_parent;
+                        x_parent = x->parent();
+                    } 
+                    else 
+                    {
+                        if (left_black) 
+                        {
+                            if (!w->right->is_header())
+                                w->right->set_color(BLACK);
+                            w->set_color(RED);
+                            _left_rotate(w);
+                            w = x_parent->left;
+                            if (!w || w->is_header()) break;
+                        }
+                        w->set_color(x_parent->color());
+                        x_parent->set_color(BLACK);
+                        if (!w->left->is_header())
+                            w->left->set_color(BLACK);
+                        _right_rotate(x_parent);
+                        x = _root;
+                    }
+                }
+            }
+
+            if (x && !x->is_header())
+                x->set_color(BLACK);
+        }
+
+        void _transplant(node_pointer u, node_pointer v) 
+        {
+            if (!u || u->is_header()) return;
+            
+            // Make sure v is a leaf if null
+            if (v == NULL) v = _leaf();
+            
+            if (u->parent()->is_header())
+                _root = v->is_header() ? _nil : v;
+            else if (u == u->parent()->left)
+                u->parent()->left = v;
+            else
+                u->parent()->right = v;
+            
+            if (!v->is_header())
+                v->set_parent(u->parent());
+        }
+
+        void _clear_recursive(node_pointer node) 
+        {
+            if (!node || node->is_header())
+                return;
+            
+            _clear_recursive(node->left);
+            _clear_recursive(node->right);
+            
+            _node_alloc.destroy(node);
+            _node_alloc.deallocate(node, 1);
+        }
+
+        node_pointer _copy_recursive(node_pointer src, node_pointer parent) 
+        {
+            if (!src || src->is_header())
+                return _leaf();
             
             node_pointer new_node = _node_alloc.allocate(1);
             _node_alloc.construct(new_node, src->value);
             
-            new_node->color = src->color;
-            new_node->parent = parent;
+            new_node->set_color(src->color());
+            new_node->set_subtree_size(src->subtree_size());
+            new_node->set_parent(parent);
             new_node->left = _copy_recursive(src->left, new_node);
             new_node->right = _copy_recursive(src->right, new_node);
             
             return new_node;
         }
 
+        // Number of elements a sorted build of [first, last) keeps (distinct
+        // keys only when unique), or size_type(-1) if the range is unsorted
+        template <class ForwardIterator>
+        size_type _count_sorted(ForwardIterator first, ForwardIterator last, bool unique) const
+        {
+            if (first == last)
+                return 0;
+
+            size_type n = 1;
+            ForwardIterator prev = first;
+            for (++first; first != last; prev = first, ++first)
+            {
+                if (_comp(KeyOfValue()(*first), KeyOfValue()(*prev)))
+                    return size_type(-1);
+                if (!unique || _comp(KeyOfValue()(*prev), KeyOfValue()(*first)))
+                    ++n;
+            }
+            return n;
+        }
+
+        // Builds a perfectly balanced subtree from the next n elements of a
+        // sorted range, in order. Every level above red_depth is complete,
+        // so coloring the nodes on red_depth red and the rest black gives
+        // every path the same black height.
+        template <class ForwardIterator>
+        node_pointer _build_subtree(ForwardIterator& first, ForwardIterator last, size_type n,
+                                    size_type depth, size_type red_depth, bool unique)
+        {
+            if (n == 0)
+                return _leaf();
+
+            size_type left_n = (n - 1) / 2;
+            node_pointer left = _build_subtree(first, last, left_n, depth + 1, red_depth, unique);
+
+            node_pointer node;
+            try
+            {
+                node = _node_alloc.allocate(1);
+                try
+                {
+                    _node_alloc.construct(node, value_type(*first));
+                }
+                catch (...)
+                {
+                    _node_alloc.deallocate(node, 1);
+                    throw;
+                }
+            }
+            catch (...)
+            {
+                _clear_recursive(left);
+                throw;
+            }
+
+            node->left = left;
+            node->right = _leaf();
+            node->set_parent(_nil);
+            node->set_color(depth == red_depth ? RED : BLACK);
+            if (!left->is_header())
+                left->set_parent(node);
+
+            ++first;
+            while (unique && first != last && !_comp(KeyOfValue()(node->value), KeyOfValue()(*first)))
+                ++first;
+
+            try
+            {
+                node->right = _build_subtree(first, last, n - 1 - left_n, depth + 1, red_depth, unique);
+            }
+            catch (...)
+            {
+                _clear_recursive(node);
+                throw;
+            }
+            if (!node->right->is_header())
+                node->right->set_parent(node);
+            node->set_subtree_size(n);
+            return node;
+        }
+
+        // Replaces the empty tree with the n elements of a sorted range
+        template <class ForwardIterator>
+        void _build(ForwardIterator first, ForwardIterator last, size_type n, bool unique)
+        {
+            size_type full_levels = 0;
+            while (full_levels + 1 < sizeof(size_type) * 8 && (size_type(1) << (full_levels + 1)) - 1 <= n)
+                ++full_levels;
+
+            _root = _build_subtree(first, last, n, 0, full_levels, unique);
+            _root->set_parent(_nil);
+            _size = n;
+            _reset_extremes();
+        }
+
+        template <class InputIterator>
+        void _insert_range(InputIterator first, InputIterator last, bool unique, std::input_iterator_tag)
+        {
+            for (; first != last; ++first)
+            {
+                if (unique)
+                    insert(end(), *first);
+                else
+                    insert_multi(end(), *first);
+            }
+        }
+
+        template <class ForwardIterator>
+        void _insert_range(ForwardIterator first, ForwardIterator last, bool unique, std::forward_iterator_tag)
+        {
+            if (_size == 0)
+            {
+                size_type n = _count_sorted(first, last, unique);
+                if (n != size_type(-1))
+                {
+                    if (n)
+                        _build(first, last, n, unique);
+                    return;
+                }
+            }
+            _insert_range(first, last, unique, std::input_iterator_tag());
+        }
+
+        template <class InputIterator>
+        void _assign_sorted(InputIterator first, InputIterator last, bool unique, std::input_iterator_tag)
+        {
+            _insert_range(first, last, unique, std::input_iterator_tag());
+        }
+
+        template <class ForwardIterator>
+        void _assign_sorted(ForwardIterator first, ForwardIterator last, bool, std::forward_iterator_tag)
+        {
+            size_type n = static_cast<size_type>(ft::distance(first, last));
+            if (n)
+                _build(first, last, n, false);
+        }
+
     public:
         rb_tree(const key_compare& comp = key_compare(),
                const allocator_type& alloc = allocator_type())
@@ -583,14 +1629,15 @@ namespace ft
         }
 
         rb_tree(const rb_tree& other)
-        : _nil(0), _root(0), _size(0), _comp(other._comp), _node_alloc(other._node_alloc)
+        : _nil(0), _root(0), _size(0), _comp(other._comp),
+          _node_alloc(select_on_container_copy(other._node_alloc))
         {
             _create_nil();
-            if (other._root != other._nil)
+            if (!other._root->is_header())
             {
                 _root = _copy_recursive(other._root, _nil);
                 _size = other._size;
-                _update_nil_pointers(_root);
+                _reset_extremes();
             }
             else
             {
@@ -617,12 +1664,11 @@ namespace ft
                 clear();
                 _comp = other._comp;
 
-                if (other._root != other._nil)
+                if (!other._root->is_header())
                 {
                     _root = _copy_recursive(other._root, _nil);
                     _size = other._size;
-                    // Ensure that all leaf nodes point to _nil
-                    _update_nil_pointers(_root);
+                    _reset_extremes();
                 }
                 else
                 {
@@ -633,35 +1679,21 @@ namespace ft
             return *this;
         }
 
-        void _update_nil_pointers(node_pointer node)
-        {
-            if (!node || node == _nil)
-                return;
-
-            if (node->left == NULL)
-                node->left = _nil;
-            if (node->right == NULL)
-                node->right = _nil;
-
-            _update_nil_pointers(node->left);
-            _update_nil_pointers(node->right);
-        }
-
         allocator_type get_allocator() const { return _node_alloc; }
 
         iterator begin()
         {
-            return iterator(_size ? minimum(_root) : _nil, this);
+            return iterator(_leftmost());
         }
         
         const_iterator begin() const
         {
-            return const_iterator(_size ? minimum(_root) : _nil, this);
+            return const_iterator(_leftmost());
         }
         
-        iterator end() { return iterator(_nil, this); }
+        iterator end() { return iterator(_nil); }
         
-        const_iterator end() const { return const_iterator(_nil, this); }
+        const_iterator end() const { return const_iterator(_nil); }
         
         reverse_iterator rbegin() { return reverse_iterator(end()); }
         
@@ -693,100 +1725,110 @@ namespace ft
             _clear_recursive(_root);
             _root = _nil;
             _size = 0;
+            _leftmost() = _nil;
+            _rightmost() = _nil;
         }
 
         ft::pair<iterator, bool> insert(const value_type& value)
         {
-            ft::pair<node_pointer, bool> pos = _find_position(KeyOfValue()(value));
+            bool left;
+            ft::pair<node_pointer, bool> pos = _find_position(KeyOfValue()(value), left);
 
             if (!pos.second)
-                return ft::make_pair(iterator(pos.first, this), false);
-
-            node_pointer new_node = _node_alloc.allocate(1);
-            _node_alloc.construct(new_node,value);
-            
-            new_node->parent = pos.first;
-            new_node->left = _nil;
-            new_node->right = _nil;
-            new_node->color = RED;
+                return ft::make_pair(iterator(pos.first), false);
+            return ft::make_pair(iterator(_link(pos.first, left, value)), true);
+        }
 
-            if (pos.first == _nil)
-                _root = new_node;
-            else if (_comp(KeyOfValue()(value), KeyOfValue()(pos.first->value)))
-                pos.first->left = new_node;
-            else
-                pos.first->right = new_node;
+        // Map lookup-or-insert in one descent. The value_type(k, obj) pair
+        // is only built when k is missing; the one-argument form also
+        // defers default-constructing the mapped value until then.
+        template <class Mapped>
+        ft::pair<iterator, bool> try_emplace(const key_type& k, const Mapped& obj)
+        {
+            bool left;
+            ft::pair<node_pointer, bool> pos = _find_position(k, left);
 
-            _insert_fixup(new_node);
-            ++_size;
-            
-            return ft::make_pair(iterator(new_node, this), true);
+            if (!pos.second)
+                return ft::make_pair(iterator(pos.first), false);
+            return ft::make_pair(iterator(_link(pos.first, left, value_type(k, obj))), true);
         }
 
-        iterator insert(iterator hint, const value_type& value)
+        ft::pair<iterator, bool> try_emplace(const key_type& k)
         {
-            (void)hint; // Note: Hint is ignored; could be optimized in the future
-            return insert(value).first;
+            bool left;
+            ft::pair<node_pointer, bool> pos = _find_position(k, left);
+
+            if (!pos.second)
+                return ft::make_pair(iterator(pos.first), false);
+            return ft::make_pair(iterator(_link(pos.first, left, value_type(k, typename value_type::second_type()))), true);
         }
 
-        void erase(iterator position)
+        // Amortized O(1) when value belongs right before or right after hint
+        iterator insert(iterator hint, const value_type& value)
         {
-            node_pointer z = position.base();
-            if (z == _nil || !z)
-                return;
-
-            node_pointer y = z;
-            node_pointer x;
-            rb_tree_color y_original_color = y->color;
+            const key_type& k = KeyOfValue()(value);
+            node_pointer h = hint.base();
 
-            if (z->left == _nil)
+            if (h->is_header())
             {
-                x = z->right;
-                _transplant(z, z->right);
+                if (_size)
+                {
+                    node_pointer last = _rightmost();
+                    if (_comp(KeyOfValue()(last->value), k))
+                        return iterator(_link(last, false, value));
+                }
+                return insert(value).first;
             }
-            else if (z->right == _nil)
+
+            if (_comp(k, KeyOfValue()(h->value)))
             {
-                x = z->left;
-                _transplant(z, z->left);
+                node_pointer before = h->prev();
+                if (before->is_header())
+                    return iterator(_link(h, true, value));
+                if (_comp(KeyOfValue()(before->value), k))
+                {
+                    if (before->right->is_header())
+                        return iterator(_link(before, false, value));
+                    return iterator(_link(h, true, value));
+                }
+                return insert(value).first;
             }
-            else
-            {
-                y = minimum(z->right);
-                y_original_color = y->color;
-                x = y->right;
 
-                if (y->parent == z)
-                    x->parent = y;
-                else
+            if (_comp(KeyOfValue()(h->value), k))
+            {
+                node_pointer after = h->next();
+                if (after->is_header())
+                    return iterator(_link(h, false, value));
+                if (_comp(k, KeyOfValue()(after->value)))
                 {
-                    _transplant(y, y->right);
-                    y->right = z->right;
-                    y->right->parent = y;
+                    if (h->right->is_header())
+                        return iterator(_link(h, false, value));
+                    return iterator(_link(after, true, value));
                 }
-
-                _transplant(z, y);
-                y->left = z->left;
-                y->left->parent = y;
-                y->color = z->color;
+                return insert(value).first;
             }
 
-            node_pointer x_parent = x == _nil ? y->parent : x->parent;
+            return hint;
+        }
+
+        void erase(iterator position)
+        {
+            node_pointer z = position.base();
+            if (!z || z->is_header())
+                return;
+
+            _unlink(z);
             _node_alloc.destroy(z);
             _node_alloc.deallocate(z, 1);
-            
-            if (y_original_color == BLACK)
-                _erase_fixup(x, x_parent);
-            
-            --_size;
         }
 
         size_type erase(const key_type& k)
         {
             node_pointer node = _find(k);
-            if (node == _nil)
+            if (node->is_header())
                 return 0;
             
-            erase(iterator(node, this));
+            erase(iterator(node));
             return 1;
         }
 
@@ -799,6 +1841,48 @@ namespace ft
             }
         }
 
+        // Node handles. extract() unlinks a node without freeing it and
+        // insert() links one back in, here or into another tree, without
+        // allocating or copying the value. A node from a tree with an
+        // unequal allocator is copied into a new node instead.
+        node_handle extract(iterator position)
+        {
+            node_pointer z = position.base();
+            if (z->is_header())
+                return node_handle(0, _node_alloc);
+
+            _unlink(z);
+            return node_handle(z, _node_alloc);
+        }
+
+        // The first element with key k, if any
+        node_handle extract(const key_type& k)
+        {
+            iterator it = lower_bound(k);
+            if (it == end() || _comp(k, KeyOfValue()(*it)))
+                return node_handle(0, _node_alloc);
+            return extract(it);
+        }
+
+        // Leaves nh holding its node when the key is already present. nh
+        // is taken by const reference so that insert(other.extract(k))
+        // works; a rejected temporary frees its node when it goes away.
+        ft::pair<iterator, bool> insert(const node_handle& nh)
+        {
+            if (nh.empty())
+                return ft::make_pair(end(), false);
+
+            bool left;
+            ft::pair<node_pointer, bool> pos = _find_position(KeyOfValue()(nh.value()), left);
+            if (!pos.second)
+                return ft::make_pair(iterator(pos.first), false);
+            return ft::make_pair(iterator(_link_handle(pos.first, left, nh)), true);
+        }
+
+        // Moves over every node of other whose key is not present here and
+        // leaves the rest in other; see _merge
+        void merge(rb_tree& other) { _merge(other, true); }
+
         void swap(rb_tree& other)
         {
             node_pointer tmp_root = _root;
@@ -822,148 +1906,365 @@ namespace ft
 
         iterator find(const key_type& k)
         {
-            return iterator(_find(k), this);
+            return iterator(_find(k));
         }
         
         const_iterator find(const key_type& k) const
         {
-            return const_iterator(_find(k), this);
+            return const_iterator(_find(k));
         }
 
         size_type count(const key_type& k) const
         {
-            return _find(k) != _nil ? 1 : 0;
+            return _find(k)->is_header() ? 0 : 1;
         }
 
-        iterator lower_bound(const key_type& k)
+        iterator lower_bound(const key_type& k) { return iterator(_lower_bound(k)); }
+        const_iterator lower_bound(const key_type& k) const { return const_iterator(_lower_bound(k)); }
+
+        iterator upper_bound(const key_type& k) { return iterator(_upper_bound(k)); }
+        const_iterator upper_bound(const key_type& k) const { return const_iterator(_upper_bound(k)); }
+
+        ft::pair<iterator, iterator> equal_range(const key_type& k)
         {
-            node_pointer current = _root;
-            node_pointer result = _nil;
-            
-            while (current != _nil)
+            return ft::make_pair(lower_bound(k), upper_bound(k));
+        }
+        
+        ft::pair<const_iterator, const_iterator> equal_range(const key_type& k) const
+        {
+            return ft::make_pair(lower_bound(k), upper_bound(k));
+        }
+
+        // Heterogeneous lookup, only when Compare declares is_transparent:
+        // k may be of any type Compare orders against key_type, e.g. a
+        // const char* against std::string keys, and is never converted.
+        // A key_type argument still picks the overloads above.
+        template <class K>
+        typename _if_transparent<Compare, K, iterator>::type find(const K& k)
+        {
+            return iterator(_find(k));
+        }
+
+        template <class K>
+        typename _if_transparent<Compare, K, const_iterator>::type find(const K& k) const
+        {
+            return const_iterator(_find(k));
+        }
+
+        template <class K>
+        typename _if_transparent<Compare, K, size_type>::type count(const K& k) const
+        {
+            return _find(k)->is_header() ? 0 : 1;
+        }
+
+        template <class K>
+        typename _if_transparent<Compare, K, iterator>::type lower_bound(const K& k)
+        {
+            return iterator(_lower_bound(k));
+        }
+
+        template <class K>
+        typename _if_transparent<Compare, K, const_iterator>::type lower_bound(const K& k) const
+        {
+            return const_iterator(_lower_bound(k));
+        }
+
+        template <class K>
+        typename _if_transparent<Compare, K, iterator>::type upper_bound(const K& k)
+        {
+            return iterator(_upper_bound(k));
+        }
+
+        template <class K>
+        typename _if_transparent<Compare, K, const_iterator>::type upper_bound(const K& k) const
+        {
+            return const_iterator(_upper_bound(k));
+        }
+
+        template <class K>
+        typename _if_transparent<Compare, K, ft::pair<iterator, iterator> >::type equal_range(const K& k)
+        {
+            return ft::make_pair(iterator(_lower_bound(k)), iterator(_upper_bound(k)));
+        }
+
+        template <class K>
+        typename _if_transparent<Compare, K, ft::pair<const_iterator, const_iterator> >::type
+        equal_range(const K& k) const
+        {
+            return ft::make_pair(const_iterator(_lower_bound(k)), const_iterator(_upper_bound(k)));
+        }
+
+        // Order statistics: O(log n) on a ranked tree, a walk over the
+        // elements on a plain one
+
+        // k-th smallest element, or end() when k >= size()
+        iterator nth(size_type k) { return iterator(_nth(k)); }
+
+        const_iterator nth(size_type k) const { return const_iterator(_nth(k)); }
+
+        // Number of elements ordered before k: the index of lower_bound(k)
+        size_type rank(const key_type& k) const { return _rank(k, false); }
+
+        // Index of the element at position; size() for end()
+        size_type index_of(const_iterator position) const
+        {
+            const_node_pointer node = position.base();
+            if (!Ranked)
+                return static_cast<size_type>(ft::distance(begin(), position));
+            if (node->is_header())
+                return _size;
+
+            size_type index = node->left->subtree_size();
+            for (; !node->parent()->is_header(); node = node->parent())
             {
-                if (!_comp(KeyOfValue()(current->value), k))
-                {
-                    result = current;
-                    current = current->left;
-                }
-                else
-                    current = current->right;
+                if (node == node->parent()->right)
+                    index += node->parent()->left->subtree_size() + 1;
             }
-            
-            return iterator(result, this);
+            return index;
         }
-        
-        const_iterator lower_bound(const key_type& k) const
+
+        // Moves every element whose key is not ordered before k into out,
+        // replacing its contents; out takes this tree's comparator and
+        // allocator. O(log n) on a ranked tree. A plain tree also counts
+        // the smaller of the two halves to keep size() O(1), so it costs
+        // O(log n + m) with m the size of that half: Theta(n) for a split
+        // down the middle.
+        void split(const key_type& k, rb_tree& out)
         {
-            node_pointer current = _root;
-            node_pointer result = _nil;
-            
-            while (current != _nil)
+            if (&out == this)
+                return;
+            out.clear();
+            out._share_policies(*this);
+            if (_size == 0)
+                return;
+
+            size_type size = _size;
+            node_pointer left;
+            node_pointer right;
+            size_type left_height;
+            size_type right_height;
+            _split(_root, _black_height(_root), k, left, left_height, right, right_height);
+
+            _adopt(left, 0);
+            out._adopt(right, 0);
+            if (Ranked)
             {
-                if (!_comp(KeyOfValue()(current->value), k))
-                {
-                    result = current;
-                    current = current->left;
-                }
-                else
-                    current = current->right;
+                _size = _root->subtree_size();
+                out._size = size - _size;
+                return;
             }
-            
-            return const_iterator(result, this);
+
+            node_pointer mine = _leftmost();
+            node_pointer theirs = out._leftmost();
+            size_type steps = 0;
+            while (!mine->is_header() && !theirs->is_header())
+            {
+                mine = mine->next();
+                theirs = theirs->next();
+                ++steps;
+            }
+            _size = mine->is_header() ? steps : size - steps;
+            out._size = size - _size;
         }
 
-        iterator upper_bound(const key_type& k)
+        // Moves every element of other into this tree in O(log n). All of
+        // other's keys must order after all of this tree's or all before
+        // them; std::invalid_argument otherwise. join() wants the two
+        // ranges disjoint, join_multi() lets them meet at one equal key.
+        // Trees with unequal allocators fall back to copying.
+        void join(rb_tree& other) { _join_trees(other, true); }
+
+        void join_multi(rb_tree& other) { _join_trees(other, false); }
+
+        // Set algebra for unique trees: this tree becomes its union,
+        // intersection or difference with other, which must be ordered by
+        // an equivalent comparator. Elements of this tree win over equal
+        // ones of other. Splits and joins take O(m log(n/m + 1)) with m
+        // the smaller size and n the larger, plus copying the elements
+        // unite() brings in. The comparator must not throw.
+        void unite(const rb_tree& other)
         {
-            node_pointer current = _root;
-            node_pointer result = _nil;
-            
-            while (current != _nil)
+            if (&other == this || other._size == 0)
+                return;
+
+            // Copies get this tree's allocator so that they can be linked in
+            rb_tree extra(_comp);
+            extra._share_policies(*this);
+            extra._root = extra._copy_recursive(other._root, extra._nil);
+            extra._size = other._size;
+
+            size_type dropped = 0;
+            size_type height;
+            node_pointer root = _unite(_root, _black_height(_root), extra._root,
+                                       _black_height(extra._root), dropped, height);
+            extra._root = extra._nil;
+            size_type size = _size + extra._size - dropped;
+            extra._size = 0;
+            _adopt(root, size);
+        }
+
+        void intersect(const rb_tree& other)
+        {
+            if (&other == this)
+                return;
+
+            size_type kept = 0;
+            size_type height;
+            node_pointer root = _intersect(_root, _black_height(_root), other._root, kept, height);
+            _adopt(root, kept);
+        }
+
+        void subtract(const rb_tree& other)
+        {
+            if (&other == this)
             {
-                if (_comp(k, KeyOfValue()(current->value)))
-                {
-                    result = current;
-                    current = current->left;
-                }
-                else
-                    current = current->right;
+                clear();
+                return;
             }
-            
-            return iterator(result, this);
+
+            size_type removed = 0;
+            size_type height;
+            node_pointer root = _subtract(_root, _black_height(_root), other._root, removed, height);
+            _adopt(root, _size - removed);
         }
-        
-        const_iterator upper_bound(const key_type& k) const
+
+        // Number of elements with a key in [lo, hi)
+        size_type count_range(const key_type& lo, const key_type& hi) const
         {
-            node_pointer current = _root;
-            node_pointer result = _nil;
-            
-            while (current != _nil)
+            if (!_comp(lo, hi))
+                return 0;
+            return _rank(hi, false) - _rank(lo, false);
+        }
+
+        key_compare key_comp() const { return _comp; }
+
+        // Checks every invariant the tree relies on: key order, parent
+        // links, a black root, no red node with a red child, the same
+        // number of black nodes on every path, subtree sizes on a ranked
+        // tree, size() and the cached extremes. O(n); meant for tests.
+        bool verify() const
+        {
+            if (_root->is_header())
+                return _root == _nil && _size == 0 && _leftmost() == _nil && _rightmost() == _nil;
+            if (_root->color() != BLACK || _root->parent() != _nil)
+                return false;
+
+            size_type count = 0;
+            if (_verify_subtree(_root, count) < 0 || count != _size)
+                return false;
+            if (_leftmost() != minimum(_root) || _rightmost() != maximum(_root))
+                return false;
+
+            const_iterator prev = begin();
+            for (const_iterator it = ++begin(); it != end(); prev = it++)
             {
-                if (_comp(k, KeyOfValue()(current->value)))
-                {
-                    result = current;
-                    current = current->left;
-                }
-                else
-                    current = current->right;
+                if (_comp(KeyOfValue()(*it), KeyOfValue()(*prev)))
+                    return false;
             }
-            
-            return const_iterator(result, this);
+            return true;
         }
 
-        ft::pair<iterator, iterator> equal_range(const key_type& k)
+        // Bulk insertion. Into an empty tree, a sorted forward range is
+        // detected with one pass of comparisons and built in O(n); anything
+        // else is inserted with end() as the hint, which is still O(1) per
+        // element while the input stays sorted.
+        template <class InputIterator>
+        void insert_range(InputIterator first, InputIterator last)
         {
-            return ft::make_pair(lower_bound(k), upper_bound(k));
+            _insert_range(first, last, true, typename ft::iterator_traits<InputIterator>::iterator_category());
         }
-        
-        ft::pair<const_iterator, const_iterator> equal_range(const key_type& k) const
+
+        template <class InputIterator>
+        void insert_range_multi(InputIterator first, InputIterator last)
         {
-            return ft::make_pair(lower_bound(k), upper_bound(k));
+            _insert_range(first, last, false, typename ft::iterator_traits<InputIterator>::iterator_category());
         }
 
-        key_compare key_comp() const { return _comp; }
+        // Replaces the contents with a range the caller guarantees to be
+        // sorted (and free of equal keys for a unique tree), without checking
+        template <class InputIterator>
+        void assign_sorted(InputIterator first, InputIterator last, bool unique)
+        {
+            clear();
+            _assign_sorted(first, last, unique, typename ft::iterator_traits<InputIterator>::iterator_category());
+        }
 
         // multimap
         public:
         
         iterator insert_multi(const value_type& value)
         {
-            node_pointer parent = _nil;
-            node_pointer current = _root;
+            bool left;
+            node_pointer parent = _multi_parent(KeyOfValue()(value), left);
+            return iterator(_link(parent, left, value));
+        }
 
-            // Find insertion position (allows duplicates)
-            while (current != _nil)
-            {
-                parent = current;
-                current = _comp(KeyOfValue()(value), KeyOfValue()(current->value)) ? 
-                         current->left : current->right;
-            }
+        // After any elements with an equal key, like insert_multi(value)
+        iterator insert_multi(const node_handle& nh)
+        {
+            if (nh.empty())
+                return end();
 
-            node_pointer new_node = _node_alloc.allocate(1);
-            _node_alloc.construct(new_node, value);
+            bool left;
+            node_pointer parent = _multi_parent(KeyOfValue()(nh.value()), left);
+            return iterator(_link_handle(parent, left, nh));
+        }
 
-            new_node->parent = parent;
-            new_node->left = _nil;
-            new_node->right = _nil;
-            new_node->color = RED;
+        void merge_multi(rb_tree& other) { _merge(other, false); }
 
-            if (parent == _nil)
-                _root = new_node;
-            else if (_comp(KeyOfValue()(value), KeyOfValue()(parent->value)))
-                parent->left = new_node;
-            else
-                parent->right = new_node;
+        // Amortized O(1) when value belongs right before or right after hint;
+        // equal keys go as close to hint as the order allows
+        iterator insert_multi(iterator hint, const value_type& value)
+        {
+            const key_type& k = KeyOfValue()(value);
+            node_pointer h = hint.base();
 
-            _insert_fixup(new_node);
-            ++_size;
+            if (h->is_header())
+            {
+                if (_size)
+                {
+                    node_pointer last = _rightmost();
+                    if (!_comp(k, KeyOfValue()(last->value)))
+                        return iterator(_link(last, false, value));
+                }
+                return insert_multi(value);
+            }
 
-            return iterator(new_node, this);
-        }
+            if (!_comp(KeyOfValue()(h->value), k))
+            {
+                node_pointer before = h->prev();
+                if (before->is_header())
+                    return iterator(_link(h, true, value));
+                if (!_comp(k, KeyOfValue()(before->value)))
+                {
+                    if (before->right->is_header())
+                        return iterator(_link(before, false, value));
+                    return iterator(_link(h, true, value));
+                }
+                return insert_multi(value);
+            }
 
-        iterator insert_multi(iterator hint, const value_type& value)
-        {
-            (void)hint; // Hint optimization can be added later
-            return insert_multi(value);
+            node_pointer after = h->next();
+            if (after->is_header())
+                return iterator(_link(h, false, value));
+            if (!_comp(KeyOfValue()(after->value), k))
+            {
+                if (h->right->is_header())
+                    return iterator(_link(h, false, value));
+                return iterator(_link(after, true, value));
+            }
+
+            // Keys equal to value all lie past hint: go before the first one
+            node_pointer parent = _nil;
+            node_pointer current = _root;
+            bool left = true;
+            while (!current->is_header())
+            {
+                parent = current;
+                left = !_comp(KeyOfValue()(current->value), k);
+                current = left ? current->left : current->right;
+            }
+            return iterator(_link(parent, left, value));
         }
 
         size_type erase_multi(const key_type& k)
@@ -982,11 +2283,24 @@ namespace ft
             return count;
         }
 
-        size_type count_multi(const key_type& k) const
+        size_type count_multi(const key_type& k) const { return _count_multi(k); }
+
+        template <class K>
+        typename _if_transparent<Compare, K, size_type>::type count_multi(const K& k) const
+        {
+            return _count_multi(k);
+        }
+
+    private:
+        template <class K>
+        size_type _count_multi(const K& k) const
         {
+            if (Ranked)
+                return _rank(k, true) - _rank(k, false);
+
             size_type count = 0;
-            const_iterator first = lower_bound(k);
-            const_iterator last = upper_bound(k);
+            const_iterator first(_lower_bound(k));
+            const_iterator last(_upper_bound(k));
 
             while (first != last)
             {
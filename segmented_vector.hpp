@@ -0,0 +1,393 @@
+#ifndef SEGMENTED_VECTOR_HPP
+#define SEGMENTED_VECTOR_HPP
+
+#include <memory>
+#include <stdexcept>
+#include <cstddef>
+#include "iterator.hpp"
+#include "vector.hpp"
+
+namespace ft
+{
+    // Random access iterator over the chunks of a segmented_vector. It walks
+    // the chunk index, so growing the index invalidates iterators; references
+    // and pointers to elements stay valid.
+    template <class T, class Ref, class Ptr, size_t ChunkSize>
+    class segmented_vector_iterator
+        : public ft::iterator<ft::random_access_iterator_tag, T, ptrdiff_t, Ptr, Ref>
+    {
+    public:
+        typedef Ref       reference;
+        typedef Ptr       pointer;
+        typedef ptrdiff_t difference_type;
+        typedef T* const* node_pointer;
+
+    private:
+        node_pointer _node;
+        size_t       _offset;
+
+        template <class, class, class, size_t> friend class segmented_vector_iterator;
+
+    public:
+        segmented_vector_iterator() : _node(NULL), _offset(0) {}
+        segmented_vector_iterator(node_pointer node, size_t offset) : _node(node), _offset(offset) {}
+
+        // iterator -> const_iterator
+        template <class R, class P>
+        segmented_vector_iterator(const segmented_vector_iterator<T, R, P, ChunkSize> &other)
+            : _node(other._node), _offset(other._offset) {}
+
+        reference operator*() const { return (*_node)[_offset]; }
+        pointer operator->() const { return &(*_node)[_offset]; }
+        reference operator[](difference_type n) const { return *(*this + n); }
+
+        segmented_vector_iterator &operator++()
+        {
+            if (++_offset == ChunkSize)
+            {
+                ++_node;
+                _offset = 0;
+            }
+            return *this;
+        }
+
+        segmented_vector_iterator operator++(int)
+        {
+            segmented_vector_iterator tmp(*this);
+            ++(*this);
+            return tmp;
+        }
+
+        segmented_vector_iterator &operator--()
+        {
+            if (_offset == 0)
+            {
+                --_node;
+                _offset = ChunkSize;
+            }
+            --_offset;
+            return *this;
+        }
+
+        segmented_vector_iterator operator--(int)
+        {
+            segmented_vector_iterator tmp(*this);
+            --(*this);
+            return tmp;
+        }
+
+        segmented_vector_iterator &operator+=(difference_type n)
+        {
+            difference_type pos = static_cast<difference_type>(_offset) + n;
+            difference_type chunk = static_cast<difference_type>(ChunkSize);
+            difference_type nodes = pos >= 0 ? pos / chunk : -((-pos - 1) / chunk) - 1;
+
+            _node += nodes;
+            _offset = static_cast<size_t>(pos - nodes * chunk);
+            return *this;
+        }
+
+        segmented_vector_iterator &operator-=(difference_type n) { return *this += -n; }
+
+        segmented_vector_iterator operator+(difference_type n) const
+        {
+            segmented_vector_iterator tmp(*this);
+            return tmp += n;
+        }
+
+        segmented_vector_iterator operator-(difference_type n) const
+        {
+            segmented_vector_iterator tmp(*this);
+            return tmp -= n;
+        }
+
+        friend segmented_vector_iterator operator+(difference_type n, const segmented_vector_iterator &it)
+        {
+            return it + n;
+        }
+
+        template <class R, class P>
+        difference_type operator-(const segmented_vector_iterator<T, R, P, ChunkSize> &rhs) const
+        {
+            return (_node - rhs._node) * static_cast<difference_type>(ChunkSize)
+                   + static_cast<difference_type>(_offset) - static_cast<difference_type>(rhs._offset);
+        }
+
+        template <class R, class P>
+        bool operator==(const segmented_vector_iterator<T, R, P, ChunkSize> &rhs) const
+        {
+            return _node == rhs._node && _offset == rhs._offset;
+        }
+
+        template <class R, class P>
+        bool operator!=(const segmented_vector_iterator<T, R, P, ChunkSize> &rhs) const
+        {
+            return !(*this == rhs);
+        }
+
+        template <class R, class P>
+        bool operator<(const segmented_vector_iterator<T, R, P, ChunkSize> &rhs) const
+        {
+            return _node < rhs._node || (_node == rhs._node && _offset < rhs._offset);
+        }
+
+        template <class R, class P>
+        bool operator>(const segmented_vector_iterator<T, R, P, ChunkSize> &rhs) const
+        {
+            return rhs < *this;
+        }
+
+        template <class R, class P>
+        bool operator<=(const segmented_vector_iterator<T, R, P, ChunkSize> &rhs) const
+        {
+            return !(rhs < *this);
+        }
+
+        template <class R, class P>
+        bool operator>=(const segmented_vector_iterator<T, R, P, ChunkSize> &rhs) const
+        {
+            return !(*this < rhs);
+        }
+    };
+
+    // Sequence stored in fixed-size chunks reachable through a chunk index.
+    // Appending never moves existing elements: growth allocates one more
+    // chunk and at most copies the index of chunk pointers.
+    template <class T, class Alloc = std::allocator<T>, size_t ChunkSize = 256>
+    class segmented_vector
+    {
+    public:
+        typedef T                                        value_type;
+        typedef Alloc                                    allocator_type;
+        typedef typename allocator_type::reference       reference;
+        typedef typename allocator_type::const_reference const_reference;
+        typedef typename allocator_type::pointer         pointer;
+        typedef typename allocator_type::const_pointer   const_pointer;
+        typedef ptrdiff_t                                difference_type;
+        typedef size_t                                   size_type;
+
+        typedef segmented_vector_iterator<T, T&, T*, ChunkSize>             iterator;
+        typedef segmented_vector_iterator<T, const T&, const T*, ChunkSize> const_iterator;
+        typedef ft::reverse_iterator<iterator>                              reverse_iterator;
+        typedef ft::reverse_iterator<const_iterator>                        const_reverse_iterator;
+
+        static const size_type chunk_size = ChunkSize;
+
+    private:
+        typedef typename allocator_type::template rebind<pointer>::other index_allocator_type;
+        typedef ft::vector<pointer, index_allocator_type>                 index_type;
+
+        allocator_type _alloc;
+        index_type     _chunks;
+        size_type      _size;
+
+        pointer _slot(size_type i) const { return _chunks[i / ChunkSize] + i % ChunkSize; }
+
+        T* const* _index() const { return _chunks.empty() ? NULL : &_chunks[0]; }
+
+        void _add_chunk()
+        {
+            pointer chunk = _alloc.allocate(ChunkSize);
+            try
+            {
+                _chunks.push_back(chunk);
+            }
+            catch (...)
+            {
+                _alloc.deallocate(chunk, ChunkSize);
+                throw;
+            }
+        }
+
+        void _release_chunks(size_type keep)
+        {
+            while (_chunks.size() > keep)
+            {
+                _alloc.deallocate(_chunks.back(), ChunkSize);
+                _chunks.pop_back();
+            }
+        }
+
+        template <class InputIterator>
+        void _append(InputIterator first, InputIterator last)
+        {
+            try
+            {
+                for (; first != last; ++first)
+                    push_back(*first);
+            }
+            catch (...)
+            {
+                clear();
+                _release_chunks(0);
+                throw;
+            }
+        }
+
+    public:
+        // Constructors
+        explicit segmented_vector(const allocator_type &alloc = allocator_type())
+            : _alloc(alloc), _chunks(), _size(0) {}
+
+        explicit segmented_vector(size_type n, const value_type &val = value_type(),
+                                  const allocator_type &alloc = allocator_type())
+            : _alloc(alloc), _chunks(), _size(0)
+        {
+            try
+            {
+                resize(n, val);
+            }
+            catch (...)
+            {
+                clear();
+                _release_chunks(0);
+                throw;
+            }
+        }
+
+        template <class InputIterator>
+        segmented_vector(InputIterator first, InputIterator last,
+                         const allocator_type &alloc = allocator_type(),
+                         typename ft::enable_if<!ft::is_integral<InputIterator>::value, InputIterator>::type* = 0)
+            : _alloc(alloc), _chunks(), _size(0)
+        {
+            _append(first, last);
+        }
+
+        segmented_vector(const segmented_vector &x)
+            : _alloc(x._alloc), _chunks(), _size(0)
+        {
+            _append(x.begin(), x.end());
+        }
+
+        // Destructor
+        ~segmented_vector()
+        {
+            clear();
+            _release_chunks(0);
+        }
+
+        // Assignment operator
+        segmented_vector &operator=(const segmented_vector &x)
+        {
+            if (this != &x)
+            {
+                segmented_vector tmp(x);
+                swap(tmp);
+            }
+            return *this;
+        }
+
+        // Iterators
+        iterator begin() { return iterator(_index(), 0); }
+        const_iterator begin() const { return const_iterator(_index(), 0); }
+
+        iterator end() { return iterator(_index() + _size / ChunkSize, _size % ChunkSize); }
+        const_iterator end() const { return const_iterator(_index() + _size / ChunkSize, _size % ChunkSize); }
+
+        reverse_iterator rbegin() { return reverse_iterator(end()); }
+        const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+
+        reverse_iterator rend() { return reverse_iterator(begin()); }
+        const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+        // Capacity
+        size_type size() const { return _size; }
+
+        size_type max_size() const { return _alloc.max_size(); }
+
+        size_type capacity() const { return _chunks.size() * ChunkSize; }
+
+        bool empty() const { return _size == 0; }
+
+        void reserve(size_type n)
+        {
+            if (n > max_size())
+                throw std::length_error("segmented_vector::reserve");
+
+            _chunks.reserve((n + ChunkSize - 1) / ChunkSize);
+            while (capacity() < n)
+                _add_chunk();
+        }
+
+        // Frees the chunks past the last element
+        void shrink_to_fit()
+        {
+            _release_chunks((_size + ChunkSize - 1) / ChunkSize);
+            _chunks.shrink_to_fit();
+        }
+
+        void resize(size_type n, value_type val = value_type())
+        {
+            while (_size > n)
+                pop_back();
+            while (_size < n)
+                push_back(val);
+        }
+
+        // Element access
+        reference operator[](size_type n) { return *_slot(n); }
+        const_reference operator[](size_type n) const { return *_slot(n); }
+
+        reference at(size_type n)
+        {
+            if (n >= _size)
+                throw std::out_of_range("segmented_vector::at");
+            return *_slot(n);
+        }
+
+        const_reference at(size_type n) const
+        {
+            if (n >= _size)
+                throw std::out_of_range("segmented_vector::at");
+            return *_slot(n);
+        }
+
+        reference front() { return *_slot(0); }
+        const_reference front() const { return *_slot(0); }
+
+        reference back() { return *_slot(_size - 1); }
+        const_reference back() const { return *_slot(_size - 1); }
+
+        // Modifiers
+        void push_back(const value_type &val)
+        {
+            if (_size == capacity())
+                _add_chunk();
+
+            _alloc.construct(_slot(_size), val);
+            ++_size;
+        }
+
+        void pop_back()
+        {
+            if (_size)
+            {
+                --_size;
+                _alloc.destroy(_slot(_size));
+            }
+        }
+
+        void clear()
+        {
+            while (_size)
+                pop_back();
+        }
+
+        void swap(segmented_vector &x)
+        {
+            ft::swap(_alloc, x._alloc);
+            _chunks.swap(x._chunks);
+            ft::swap(_size, x._size);
+        }
+
+        // Allocator
+        allocator_type get_allocator() const { return _alloc; }
+    };
+
+    template <class T, class Alloc, size_t ChunkSize>
+    const typename segmented_vector<T, Alloc, ChunkSize>::size_type
+    segmented_vector<T, Alloc, ChunkSize>::chunk_size;
+}
+
+#endif // SEGMENTED_VECTOR_HPP
@@ -11,30 +11,32 @@
 
 namespace ft
 {
-    // Forward declarations
+    // Forward declarations. Ranked sets keep subtree sizes in their
+    // nodes, one word each, so nth(), rank(), index_of() and count_range()
+    // run in O(log n) instead of walking the elements.
     template <class T, class Compare = std::less<T>,
-              class Allocator = std::allocator<T> >
+              class Allocator = std::allocator<T>, bool Ranked = false>
     class multiset;
 
     template <class T, class Compare = std::less<T>,
-              class Allocator = std::allocator<T> >
+              class Allocator = std::allocator<T>, bool Ranked = false>
     class set;
 
-    template <class T, class Compare, class Allocator>
-    bool operator==(const multiset<T, Compare, Allocator>& lhs,
-                   const multiset<T, Compare, Allocator>& rhs);
+    template <class T, class Compare, class Allocator, bool Ranked>
+    bool operator==(const multiset<T, Compare, Allocator, Ranked>& lhs,
+                   const multiset<T, Compare, Allocator, Ranked>& rhs);
 
-    template <class T, class Compare, class Allocator>
-    bool operator<(const multiset<T, Compare, Allocator>& lhs,
-                  const multiset<T, Compare, Allocator>& rhs);
+    template <class T, class Compare, class Allocator, bool Ranked>
+    bool operator<(const multiset<T, Compare, Allocator, Ranked>& lhs,
+                  const multiset<T, Compare, Allocator, Ranked>& rhs);
 
-    template <class T, class Compare, class Allocator>
-    bool operator==(const set<T, Compare, Allocator>& lhs,
-                   const set<T, Compare, Allocator>& rhs);
+    template <class T, class Compare, class Allocator, bool Ranked>
+    bool operator==(const set<T, Compare, Allocator, Ranked>& lhs,
+                   const set<T, Compare, Allocator, Ranked>& rhs);
 
-    template <class T, class Compare, class Allocator>
-    bool operator<(const set<T, Compare, Allocator>& lhs,
-                  const set<T, Compare, Allocator>& rhs);
+    template <class T, class Compare, class Allocator, bool Ranked>
+    bool operator<(const set<T, Compare, Allocator, Ranked>& lhs,
+                  const set<T, Compare, Allocator, Ranked>& rhs);
 
     // Identity functor to use with the rb_tree
     template <class T>
@@ -51,7 +53,7 @@ namespace ft
         }
     };
 
-    template <class T, class Compare, class Allocator>
+    template <class T, class Compare, class Allocator, bool Ranked>
     class multiset
     {
     public:
@@ -68,15 +70,19 @@ namespace ft
         typedef typename allocator_type::difference_type difference_type;
 
     private:
-        typedef rb_tree<key_type, value_type, Identity<value_type>, key_compare, allocator_type> tree_type;
+        typedef rb_tree<key_type, value_type, Identity<value_type>, key_compare, allocator_type, Ranked> tree_type;
         tree_type _tree;
 
+        // set keeps its elements in a multiset and uses the unique inserts
+        friend class set<T, Compare, Allocator, Ranked>;
+
     public:
         // Iterator types
         typedef typename tree_type::iterator         iterator;
         typedef typename tree_type::const_iterator         const_iterator;
         typedef typename tree_type::reverse_iterator reverse_iterator;
         typedef typename tree_type::const_reverse_iterator const_reverse_iterator;
+        typedef typename tree_type::node_handle            node_type;
 
         // Constructors, destructor and assignment operator
         explicit multiset(const key_compare& comp = key_compare(),
@@ -92,6 +98,16 @@ namespace ft
             insert(first, last);
         }
 
+        // [first, last) must be sorted
+        template <class InputIterator>
+        multiset(ft::sorted_range_tag, InputIterator first, InputIterator last,
+                const key_compare& comp = key_compare(),
+                const allocator_type& alloc = allocator_type())
+            : _tree(comp, alloc)
+        {
+            _tree.assign_sorted(first, last, false);
+        }
+
         multiset(const multiset& x) : _tree(x._tree) {}
 
         ~multiset() {}
@@ -121,48 +137,58 @@ namespace ft
         // Modifiers
         iterator insert(const value_type& val)
         {
-            return _tree.insert(val).first;
+            return _tree.insert_multi(val);
         }
 
         iterator insert(iterator position, const value_type& val)
         {
-            (void)position;
-            return _tree.insert(val).first;
+            return _tree.insert_multi(position, val);
         }
 
         template <class InputIterator>
         void insert(InputIterator first, InputIterator last)
         {
-            for (; first != last; ++first)
-                _tree.insert(*first);
+            _tree.insert_range_multi(first, last);
         }
 
         void erase(iterator position)
         {
-            if (position != end())
-                _tree.erase(*position);
+            _tree.erase(position);
         }
 
         size_type erase(const key_type& k)
         {
-            return _tree.erase(k);
+            return _tree.erase_multi(k);
         }
 
         void erase(iterator first, iterator last)
         {
-            while (first != last)
-            {
-                value_type val = *first;
-                ++first;
-                _tree.erase(val);
-            }
+            _tree.erase(first, last);
         }
 
+        // Node handles: the value moves between containers, or is changed,
+        // without being copied or reallocated
+        node_type extract(iterator position) { return _tree.extract(position); }
+        node_type extract(const key_type& k) { return _tree.extract(k); }
+
+        iterator insert(const node_type& nh) { return _tree.insert_multi(nh); }
+
+        // Moves every value of x over, without copying them
+        void merge(multiset& x) { _tree.merge_multi(x._tree); }
+
         void swap(multiset& x)
         {
             _tree.swap(x._tree);
         }
 
+        // Moves the values from k on into out (see rb_tree::split)
+        void split(const key_type& k, multiset& out) { _tree.split(k, out._tree); }
+
+        // Moves every value of other in, in O(log n); other's values must all
+        // order before or after ours, equal ones only at the seam
+        // (std::invalid_argument otherwise)
+        void join(multiset& other) { _tree.join_multi(other._tree); }
+
         void clear()
         {
             _tree.clear();
@@ -192,7 +218,7 @@ namespace ft
 
         size_type count(const key_type& k) const
         {
-            return _tree.count(k);
+            return _tree.count_multi(k);
         }
 
         iterator lower_bound(const key_type& k)
@@ -225,6 +251,75 @@ namespace ft
             return _tree.equal_range(k);
         }
 
+        // Heterogeneous lookup
+        template <class K>
+        typename _if_transparent<key_compare, K, iterator>::type find(const K& k)
+        {
+            return _tree.find(k);
+        }
+
+        template <class K>
+        typename _if_transparent<key_compare, K, const_iterator>::type find(const K& k) const
+        {
+            return _tree.find(k);
+        }
+
+        template <class K>
+        typename _if_transparent<key_compare, K, size_type>::type count(const K& k) const
+        {
+            return _tree.count_multi(k);
+        }
+
+        template <class K>
+        typename _if_transparent<key_compare, K, iterator>::type lower_bound(const K& k)
+        {
+            return _tree.lower_bound(k);
+        }
+
+        template <class K>
+        typename _if_transparent<key_compare, K, const_iterator>::type lower_bound(const K& k) const
+        {
+            return _tree.lower_bound(k);
+        }
+
+        template <class K>
+        typename _if_transparent<key_compare, K, iterator>::type upper_bound(const K& k)
+        {
+            return _tree.upper_bound(k);
+        }
+
+        template <class K>
+        typename _if_transparent<key_compare, K, const_iterator>::type upper_bound(const K& k) const
+        {
+            return _tree.upper_bound(k);
+        }
+
+        template <class K>
+        typename _if_transparent<key_compare, K, ft::pair<iterator, iterator> >::type equal_range(const K& k)
+        {
+            return _tree.equal_range(k);
+        }
+
+        template <class K>
+        typename _if_transparent<key_compare, K, ft::pair<const_iterator, const_iterator> >::type
+        equal_range(const K& k) const
+        {
+            return _tree.equal_range(k);
+        }
+
+        // Order statistics, O(log n) when Ranked and linear otherwise
+        iterator nth(size_type k) { return _tree.nth(k); }
+        const_iterator nth(size_type k) const { return _tree.nth(k); }
+
+        size_type rank(const key_type& k) const { return _tree.rank(k); }
+
+        size_type index_of(const_iterator position) const { return _tree.index_of(position); }
+
+        size_type count_range(const key_type& lo, const key_type& hi) const
+        {
+            return _tree.count_range(lo, hi);
+        }
+
         // Allocator
         allocator_type get_allocator() const
         {
@@ -232,7 +327,7 @@ namespace ft
         }
     };
 
-    template <class T, class Compare, class Allocator>
+    template <class T, class Compare, class Allocator, bool Ranked>
     class set
     {
     public:
@@ -249,7 +344,7 @@ namespace ft
         typedef typename allocator_type::difference_type difference_type;
 
     private:
-        typedef multiset<key_type, key_compare, allocator_type> multiset_type;
+        typedef multiset<key_type, key_compare, allocator_type, Ranked> multiset_type;
         multiset_type _mset;
 
     public:
@@ -258,6 +353,7 @@ namespace ft
         typedef typename multiset_type::const_iterator         const_iterator;
         typedef typename multiset_type::reverse_iterator reverse_iterator;
         typedef typename multiset_type::const_reverse_iterator const_reverse_iterator;
+        typedef typename multiset_type::node_type              node_type;
 
         // Constructors, destructor and assignment operator
         explicit set(const key_compare& comp = key_compare(),
@@ -273,6 +369,13 @@ namespace ft
             insert(first, last);
         }
 
+        // [first, last) must be sorted with no value repeated
+        template <class InputIterator>
+        set(ft::sorted_range_tag tag, InputIterator first, InputIterator last,
+           const key_compare& comp = key_compare(),
+           const allocator_type& alloc = allocator_type())
+            : _mset(tag, first, last, comp, alloc) {}
+
         set(const set& x) : _mset(x._mset) {}
 
         ~set() {}
@@ -302,24 +405,18 @@ namespace ft
         // Modifiers
         ft::pair<iterator, bool> insert(const value_type& val)
         {
-            if (_mset.find(val) != _mset.end())
-                return ft::pair<iterator, bool>(_mset.find(val), false);
-            return ft::pair<iterator, bool>(_mset.insert(val), true);
+            return _mset._tree.insert(val);
         }
 
         iterator insert(iterator position, const value_type& val)
         {
-            if (_mset.find(val) != _mset.end())
-                return _mset.find(val);
-            (void)position;
-            return _mset.insert(val);
+            return _mset._tree.insert(position, val);
         }
 
         template <class InputIterator>
         void insert(InputIterator first, InputIterator last)
         {
-            for (; first != last; ++first)
-                insert(*first);
+            _mset._tree.insert_range(first, last);
         }
 
         void erase(iterator position)
@@ -342,11 +439,36 @@ namespace ft
             _mset.erase(first, last);
         }
 
+        // Node handles: the value moves between containers, or is changed,
+        // without being copied or reallocated
+        node_type extract(iterator position) { return _mset.extract(position); }
+        node_type extract(const key_type& k) { return _mset.extract(k); }
+
+        // nh keeps its node if the value is already present
+        ft::pair<iterator, bool> insert(const node_type& nh) { return _mset._tree.insert(nh); }
+
+        // Moves over the values of x not present here, without copying
+        // them; the others stay in x
+        void merge(set& x) { _mset._tree.merge(x._mset._tree); }
+
         void swap(set& x)
         {
             _mset.swap(x._mset);
         }
 
+        // Moves the values from k on into out (see rb_tree::split)
+        void split(const key_type& k, set& out) { _mset._tree.split(k, out._mset._tree); }
+
+        // Moves every value of other in, in O(log n); other's values must all
+        // order before or after ours (std::invalid_argument)
+        void join(set& other) { _mset._tree.join(other._mset._tree); }
+
+        // In-place union, intersection and difference, O(m log(n/m + 1))
+        // for sizes m <= n (see rb_tree::unite)
+        void unite(const set& other) { _mset._tree.unite(other._mset._tree); }
+        void intersect(const set& other) { _mset._tree.intersect(other._mset._tree); }
+        void subtract(const set& other) { _mset._tree.subtract(other._mset._tree); }
+
         void clear()
         {
             _mset.clear();
@@ -409,6 +531,75 @@ namespace ft
             return _mset.equal_range(k);
         }
 
+        // Heterogeneous lookup
+        template <class K>
+        typename _if_transparent<key_compare, K, iterator>::type find(const K& k)
+        {
+            return _mset.find(k);
+        }
+
+        template <class K>
+        typename _if_transparent<key_compare, K, const_iterator>::type find(const K& k) const
+        {
+            return _mset.find(k);
+        }
+
+        template <class K>
+        typename _if_transparent<key_compare, K, size_type>::type count(const K& k) const
+        {
+            return _mset.find(k) != _mset.end() ? 1 : 0;
+        }
+
+        template <class K>
+        typename _if_transparent<key_compare, K, iterator>::type lower_bound(const K& k)
+        {
+            return _mset.lower_bound(k);
+        }
+
+        template <class K>
+        typename _if_transparent<key_compare, K, const_iterator>::type lower_bound(const K& k) const
+        {
+            return _mset.lower_bound(k);
+        }
+
+        template <class K>
+        typename _if_transparent<key_compare, K, iterator>::type upper_bound(const K& k)
+        {
+            return _mset.upper_bound(k);
+        }
+
+        template <class K>
+        typename _if_transparent<key_compare, K, const_iterator>::type upper_bound(const K& k) const
+        {
+            return _mset.upper_bound(k);
+        }
+
+        template <class K>
+        typename _if_transparent<key_compare, K, ft::pair<iterator, iterator> >::type equal_range(const K& k)
+        {
+            return _mset.equal_range(k);
+        }
+
+        template <class K>
+        typename _if_transparent<key_compare, K, ft::pair<const_iterator, const_iterator> >::type
+        equal_range(const K& k) const
+        {
+            return _mset.equal_range(k);
+        }
+
+        // Order statistics, O(log n) when Ranked and linear otherwise
+        iterator nth(size_type k) { return _mset.nth(k); }
+        const_iterator nth(size_type k) const { return _mset.nth(k); }
+
+        size_type rank(const key_type& k) const { return _mset.rank(k); }
+
+        size_type index_of(const_iterator position) const { return _mset.index_of(position); }
+
+        size_type count_range(const key_type& lo, const key_type& hi) const
+        {
+            return _mset.count_range(lo, hi);
+        }
+
         // Allocator
         allocator_type get_allocator() const
         {
@@ -417,15 +608,15 @@ namespace ft
     };
 
     // Non-member functions for multiset
-    template <class T, class Compare, class Allocator>
-    bool operator==(const multiset<T, Compare, Allocator>& lhs,
-                   const multiset<T, Compare, Allocator>& rhs)
+    template <class T, class Compare, class Allocator, bool Ranked>
+    bool operator==(const multiset<T, Compare, Allocator, Ranked>& lhs,
+                   const multiset<T, Compare, Allocator, Ranked>& rhs)
     {
         if (lhs.size() != rhs.size())
             return false;
         
-        typename multiset<T, Compare, Allocator>::const_iterator lit = lhs.begin();
-        typename multiset<T, Compare, Allocator>::const_iterator rit = rhs.begin();
+        typename multiset<T, Compare, Allocator, Ranked>::const_iterator lit = lhs.begin();
+        typename multiset<T, Compare, Allocator, Ranked>::const_iterator rit = rhs.begin();
         
         for (; lit != lhs.end() && rit != rhs.end(); ++lit, ++rit)
         {
@@ -435,19 +626,19 @@ namespace ft
         return lit == lhs.end() && rit == rhs.end();
     }
 
-    template <class T, class Compare, class Allocator>
-    bool operator!=(const multiset<T, Compare, Allocator>& lhs,
-                   const multiset<T, Compare, Allocator>& rhs)
+    template <class T, class Compare, class Allocator, bool Ranked>
+    bool operator!=(const multiset<T, Compare, Allocator, Ranked>& lhs,
+                   const multiset<T, Compare, Allocator, Ranked>& rhs)
     {
         return !(lhs == rhs);
     }
 
-    template <class T, class Compare, class Allocator>
-    bool operator<(const multiset<T, Compare, Allocator>& lhs,
-                  const multiset<T, Compare, Allocator>& rhs)
+    template <class T, class Compare, class Allocator, bool Ranked>
+    bool operator<(const multiset<T, Compare, Allocator, Ranked>& lhs,
+                  const multiset<T, Compare, Allocator, Ranked>& rhs)
     {
-        typename multiset<T, Compare, Allocator>::const_iterator lit = lhs.begin();
-        typename multiset<T, Compare, Allocator>::const_iterator rit = rhs.begin();
+        typename multiset<T, Compare, Allocator, Ranked>::const_iterator lit = lhs.begin();
+        typename multiset<T, Compare, Allocator, Ranked>::const_iterator rit = rhs.begin();
         
         for (; lit != lhs.end() && rit != rhs.end(); ++lit, ++rit)
         {
@@ -459,44 +650,44 @@ namespace ft
         return lit == lhs.end() && rit != rhs.end();
     }
 
-    template <class T, class Compare, class Allocator>
-    bool operator<=(const multiset<T, Compare, Allocator>& lhs,
-                   const multiset<T, Compare, Allocator>& rhs)
+    template <class T, class Compare, class Allocator, bool Ranked>
+    bool operator<=(const multiset<T, Compare, Allocator, Ranked>& lhs,
+                   const multiset<T, Compare, Allocator, Ranked>& rhs)
     {
         return !(rhs < lhs);
     }
 
-    template <class T, class Compare, class Allocator>
-    bool operator>(const multiset<T, Compare, Allocator>& lhs,
-                  const multiset<T, Compare, Allocator>& rhs)
+    template <class T, class Compare, class Allocator, bool Ranked>
+    bool operator>(const multiset<T, Compare, Allocator, Ranked>& lhs,
+                  const multiset<T, Compare, Allocator, Ranked>& rhs)
     {
         return rhs < lhs;
     }
 
-    template <class T, class Compare, class Allocator>
-    bool operator>=(const multiset<T, Compare, Allocator>& lhs,
-                   const multiset<T, Compare, Allocator>& rhs)
+    template <class T, class Compare, class Allocator, bool Ranked>
+    bool operator>=(const multiset<T, Compare, Allocator, Ranked>& lhs,
+                   const multiset<T, Compare, Allocator, Ranked>& rhs)
     {
         return !(lhs < rhs);
     }
 
-    template <class T, class Compare, class Allocator>
-    void swap(multiset<T, Compare, Allocator>& x,
-             multiset<T, Compare, Allocator>& y)
+    template <class T, class Compare, class Allocator, bool Ranked>
+    void swap(multiset<T, Compare, Allocator, Ranked>& x,
+             multiset<T, Compare, Allocator, Ranked>& y)
     {
         x.swap(y);
     }
 
     // Non-member functions for set
-    template <class T, class Compare, class Allocator>
-    bool operator==(const set<T, Compare, Allocator>& lhs,
-                   const set<T, Compare, Allocator>& rhs)
+    template <class T, class Compare, class Allocator, bool Ranked>
+    bool operator==(const set<T, Compare, Allocator, Ranked>& lhs,
+                   const set<T, Compare, Allocator, Ranked>& rhs)
     {
         if (lhs.size() != rhs.size())
             return false;
         
-        typename set<T, Compare, Allocator>::const_iterator lit = lhs.begin();
-        typename set<T, Compare, Allocator>::const_iterator rit = rhs.begin();
+        typename set<T, Compare, Allocator, Ranked>::const_iterator lit = lhs.begin();
+        typename set<T, Compare, Allocator, Ranked>::const_iterator rit = rhs.begin();
         
         for (; lit != lhs.end() && rit != rhs.end(); ++lit, ++rit)
         {
@@ -506,19 +697,19 @@ namespace ft
         return lit == lhs.end() && rit == rhs.end();
     }
 
-    template <class T, class Compare, class Allocator>
-    bool operator!=(const set<T, Compare, Allocator>& lhs,
-                   const set<T, Compare, Allocator>& rhs)
+    template <class T, class Compare, class Allocator, bool Ranked>
+    bool operator!=(const set<T, Compare, Allocator, Ranked>& lhs,
+                   const set<T, Compare, Allocator, Ranked>& rhs)
     {
         return !(lhs == rhs);
     }
 
-    template <class T, class Compare, class Allocator>
-    bool operator<(const set<T, Compare, Allocator>& lhs,
-                  const set<T, Compare, Allocator>& rhs)
+    template <class T, class Compare, class Allocator, bool Ranked>
+    bool operator<(const set<T, Compare, Allocator, Ranked>& lhs,
+                  const set<T, Compare, Allocator, Ranked>& rhs)
     {
-        typename set<T, Compare, Allocator>::const_iterator lit = lhs.begin();
-        typename set<T, Compare, Allocator>::const_iterator rit = rhs.begin();
+        typename set<T, Compare, Allocator, Ranked>::const_iterator lit = lhs.begin();
+        typename set<T, Compare, Allocator, Ranked>::const_iterator rit = rhs.begin();
         
         for (; lit != lhs.end() && rit != rhs.end(); ++lit, ++rit)
         {
@@ -530,30 +721,30 @@ namespace ft
         return lit == lhs.end() && rit != rhs.end();
     }
 
-    template <class T, class Compare, class Allocator>
-    bool operator<=(const set<T, Compare, Allocator>& lhs,
-                   const set<T, Compare, Allocator>& rhs)
+    template <class T, class Compare, class Allocator, bool Ranked>
+    bool operator<=(const set<T, Compare, Allocator, Ranked>& lhs,
+                   const set<T, Compare, Allocator, Ranked>& rhs)
     {
         return !(rhs < lhs);
     }
 
-    template <class T, class Compare, class Allocator>
-    bool operator>(const set<T, Compare, Allocator>& lhs,
-                  const set<T, Compare, Allocator>& rhs)
+    template <class T, class Compare, class Allocator, bool Ranked>
+    bool operator>(const set<T, Compare, Allocator, Ranked>& lhs,
+                  const set<T, Compare, Allocator, Ranked>& rhs)
     {
         return rhs < lhs;
     }
 
-    template <class T, class Compare, class Allocator>
-    bool operator>=(const set<T, Compare, Allocator>& lhs,
-                   const set<T, Compare, Allocator>& rhs)
+    template <class T, class Compare, class Allocator, bool Ranked>
+    bool operator>=(const set<T, Compare, Allocator, Ranked>& lhs,
+                   const set<T, Compare, Allocator, Ranked>& rhs)
     {
         return !(lhs < rhs);
     }
 
-    template <class T, class Compare, class Allocator>
-    void swap(set<T, Compare, Allocator>& x,
-             set<T, Compare, Allocator>& y)
+    template <class T, class Compare, class Allocator, bool Ranked>
+    void swap(set<T, Compare, Allocator, Ranked>& x,
+             set<T, Compare, Allocator, Ranked>& y)
     {
         x.swap(y);
     }
@@ -0,0 +1,399 @@
+#ifndef SIMD_HPP
+#define SIMD_HPP
+
+#include <cstddef>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+# define FT_SIMD_X86 1
+# include <immintrin.h>
+#endif
+
+// Low-level kernels used by the algorithms in iterator.hpp when both ranges
+// are contiguous and hold arithmetic values, by the word-level operations
+// of vector<bool> and by compressed_int_vector's bulk decode. SSE2 kernels are picked at compile time,
+// AVX2/POPCNT ones at run time through CPU detection.
+namespace ft
+{
+namespace simd
+{
+#ifdef FT_SIMD_X86
+    inline bool has_avx2()
+    {
+        static const bool supported = __builtin_cpu_supports("avx2");
+        return supported;
+    }
+
+    __attribute__((target("avx2")))
+    inline size_t _mismatch_bytes_avx2(const unsigned char *a, const unsigned char *b, size_t n)
+    {
+        size_t i = 0;
+        for (; i + 32 <= n; i += 32)
+        {
+            __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+            __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+            unsigned int mask = static_cast<unsigned int>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(va, vb)));
+            if (mask != 0xFFFFFFFFu)
+                return i + __builtin_ctz(~mask);
+        }
+        return i;
+    }
+
+    __attribute__((target("avx2")))
+    inline size_t _mismatch_avx2(const float *a, const float *b, size_t n)
+    {
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8)
+        {
+            __m256 eq = _mm256_cmp_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), _CMP_EQ_OQ);
+            unsigned int mask = static_cast<unsigned int>(_mm256_movemask_ps(eq));
+            if (mask != 0xFFu)
+                return i + __builtin_ctz(~mask);
+        }
+        return i;
+    }
+
+    __attribute__((target("avx2")))
+    inline size_t _mismatch_avx2(const double *a, const double *b, size_t n)
+    {
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4)
+        {
+            __m256d eq = _mm256_cmp_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i), _CMP_EQ_OQ);
+            unsigned int mask = static_cast<unsigned int>(_mm256_movemask_pd(eq));
+            if (mask != 0xFu)
+                return i + __builtin_ctz(~mask);
+        }
+        return i;
+    }
+
+    __attribute__((target("avx2")))
+    inline size_t _mismatch_ordered_avx2(const float *a, const float *b, size_t n)
+    {
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8)
+        {
+            __m256 va = _mm256_loadu_ps(a + i);
+            __m256 vb = _mm256_loadu_ps(b + i);
+            __m256 ne = _mm256_or_ps(_mm256_cmp_ps(va, vb, _CMP_LT_OQ), _mm256_cmp_ps(va, vb, _CMP_GT_OQ));
+            unsigned int mask = static_cast<unsigned int>(_mm256_movemask_ps(ne));
+            if (mask)
+                return i + __builtin_ctz(mask);
+        }
+        return i;
+    }
+
+    __attribute__((target("avx2")))
+    inline size_t _mismatch_ordered_avx2(const double *a, const double *b, size_t n)
+    {
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4)
+        {
+            __m256d va = _mm256_loadu_pd(a + i);
+            __m256d vb = _mm256_loadu_pd(b + i);
+            __m256d ne = _mm256_or_pd(_mm256_cmp_pd(va, vb, _CMP_LT_OQ), _mm256_cmp_pd(va, vb, _CMP_GT_OQ));
+            unsigned int mask = static_cast<unsigned int>(_mm256_movemask_pd(ne));
+            if (mask)
+                return i + __builtin_ctz(mask);
+        }
+        return i;
+    }
+
+    inline bool has_popcnt()
+    {
+        static const bool supported = __builtin_cpu_supports("popcnt");
+        return supported;
+    }
+
+    __attribute__((target("popcnt")))
+    inline size_t _popcount_hw(const unsigned long *w, size_t n)
+    {
+        size_t total = 0;
+        for (size_t i = 0; i < n; ++i)
+            total += __builtin_popcountl(w[i]);
+        return total;
+    }
+
+    // dst[i] op= src[i] over whole 256-bit blocks; returns the words done
+    __attribute__((target("avx2")))
+    inline size_t _and_words_avx2(unsigned long *dst, const unsigned long *src, size_t n)
+    {
+        const size_t step = sizeof(__m256i) / sizeof(unsigned long);
+        size_t i = 0;
+        for (; i + step <= n; i += step)
+        {
+            __m256i *d = reinterpret_cast<__m256i*>(dst + i);
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+            _mm256_storeu_si256(d, _mm256_and_si256(_mm256_loadu_si256(d), v));
+        }
+        return i;
+    }
+
+    __attribute__((target("avx2")))
+    inline size_t _or_words_avx2(unsigned long *dst, const unsigned long *src, size_t n)
+    {
+        const size_t step = sizeof(__m256i) / sizeof(unsigned long);
+        size_t i = 0;
+        for (; i + step <= n; i += step)
+        {
+            __m256i *d = reinterpret_cast<__m256i*>(dst + i);
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+            _mm256_storeu_si256(d, _mm256_or_si256(_mm256_loadu_si256(d), v));
+        }
+        return i;
+    }
+
+    __attribute__((target("avx2")))
+    inline size_t _xor_words_avx2(unsigned long *dst, const unsigned long *src, size_t n)
+    {
+        const size_t step = sizeof(__m256i) / sizeof(unsigned long);
+        size_t i = 0;
+        for (; i + step <= n; i += step)
+        {
+            __m256i *d = reinterpret_cast<__m256i*>(dst + i);
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+            _mm256_storeu_si256(d, _mm256_xor_si256(_mm256_loadu_si256(d), v));
+        }
+        return i;
+    }
+#else
+    inline bool has_avx2() { return false; }
+    inline bool has_popcnt() { return false; }
+#endif
+
+#ifdef __SSE2__
+    inline size_t _mismatch_bytes_sse2(const unsigned char *a, const unsigned char *b, size_t n)
+    {
+        size_t i = 0;
+        for (; i + 16 <= n; i += 16)
+        {
+            __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+            __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+            unsigned int mask = static_cast<unsigned int>(_mm_movemask_epi8(_mm_cmpeq_epi8(va, vb)));
+            if (mask != 0xFFFFu)
+                return i + __builtin_ctz(~mask);
+        }
+        return i;
+    }
+
+    inline size_t _mismatch_sse2(const float *a, const float *b, size_t n)
+    {
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4)
+        {
+            unsigned int mask = static_cast<unsigned int>(
+                _mm_movemask_ps(_mm_cmpeq_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i))));
+            if (mask != 0xFu)
+                return i + __builtin_ctz(~mask);
+        }
+        return i;
+    }
+
+    inline size_t _mismatch_sse2(const double *a, const double *b, size_t n)
+    {
+        size_t i = 0;
+        for (; i + 2 <= n; i += 2)
+        {
+            unsigned int mask = static_cast<unsigned int>(
+                _mm_movemask_pd(_mm_cmpeq_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i))));
+            if (mask != 0x3u)
+                return i + __builtin_ctz(~mask);
+        }
+        return i;
+    }
+
+    inline size_t _mismatch_ordered_sse2(const float *a, const float *b, size_t n)
+    {
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4)
+        {
+            __m128 va = _mm_loadu_ps(a + i);
+            __m128 vb = _mm_loadu_ps(b + i);
+            unsigned int mask = static_cast<unsigned int>(
+                _mm_movemask_ps(_mm_or_ps(_mm_cmplt_ps(va, vb), _mm_cmpgt_ps(va, vb))));
+            if (mask)
+                return i + __builtin_ctz(mask);
+        }
+        return i;
+    }
+
+    inline size_t _mismatch_ordered_sse2(const double *a, const double *b, size_t n)
+    {
+        size_t i = 0;
+        for (; i + 2 <= n; i += 2)
+        {
+            __m128d va = _mm_loadu_pd(a + i);
+            __m128d vb = _mm_loadu_pd(b + i);
+            unsigned int mask = static_cast<unsigned int>(
+                _mm_movemask_pd(_mm_or_pd(_mm_cmplt_pd(va, vb), _mm_cmpgt_pd(va, vb))));
+            if (mask)
+                return i + __builtin_ctz(mask);
+        }
+        return i;
+    }
+#endif
+
+    // Number of set bits in w[0, n)
+    inline size_t popcount(const unsigned long *w, size_t n)
+    {
+#ifdef FT_SIMD_X86
+        if (has_popcnt())
+            return _popcount_hw(w, n);
+#endif
+        size_t total = 0;
+        for (size_t i = 0; i < n; ++i)
+            total += __builtin_popcountl(w[i]);
+        return total;
+    }
+
+    // dst[i] &= src[i], dst[i] |= src[i], dst[i] ^= src[i] for i in [0, n)
+    inline void and_words(unsigned long *dst, const unsigned long *src, size_t n)
+    {
+        size_t i = 0;
+#ifdef FT_SIMD_X86
+        if (has_avx2())
+            i = _and_words_avx2(dst, src, n);
+#endif
+        for (; i < n; ++i)
+            dst[i] &= src[i];
+    }
+
+    inline void or_words(unsigned long *dst, const unsigned long *src, size_t n)
+    {
+        size_t i = 0;
+#ifdef FT_SIMD_X86
+        if (has_avx2())
+            i = _or_words_avx2(dst, src, n);
+#endif
+        for (; i < n; ++i)
+            dst[i] |= src[i];
+    }
+
+    inline void xor_words(unsigned long *dst, const unsigned long *src, size_t n)
+    {
+        size_t i = 0;
+#ifdef FT_SIMD_X86
+        if (has_avx2())
+            i = _xor_words_avx2(dst, src, n);
+#endif
+        for (; i < n; ++i)
+            dst[i] ^= src[i];
+    }
+
+    // In-place inclusive prefix sum seeded with base:
+    // v[i] = base + v[0] + ... + v[i]. Wraps around like unsigned arithmetic.
+    template <class T>
+    void prefix_sum(T *v, size_t n, T base)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            base += v[i];
+            v[i] = base;
+        }
+    }
+
+#ifdef __SSE2__
+    inline void prefix_sum(unsigned int *v, size_t n, unsigned int base)
+    {
+        size_t i = 0;
+        __m128i carry = _mm_set1_epi32(static_cast<int>(base));
+        for (; i + 4 <= n; i += 4)
+        {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(v + i));
+            x = _mm_add_epi32(x, _mm_slli_si128(x, 4));
+            x = _mm_add_epi32(x, _mm_slli_si128(x, 8));
+            x = _mm_add_epi32(x, carry);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(v + i), x);
+            carry = _mm_shuffle_epi32(x, 0xFF);
+        }
+        if (i)
+            base = v[i - 1];
+        for (; i < n; ++i)
+        {
+            base += v[i];
+            v[i] = base;
+        }
+    }
+
+# ifdef __LP64__
+    inline void prefix_sum(unsigned long *v, size_t n, unsigned long base)
+    {
+        size_t i = 0;
+        __m128i carry = _mm_set1_epi64x(static_cast<long>(base));
+        for (; i + 2 <= n; i += 2)
+        {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(v + i));
+            x = _mm_add_epi64(x, _mm_slli_si128(x, 8));
+            x = _mm_add_epi64(x, carry);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(v + i), x);
+            carry = _mm_unpackhi_epi64(x, x);
+        }
+        if (i)
+            base = v[i - 1];
+        for (; i < n; ++i)
+        {
+            base += v[i];
+            v[i] = base;
+        }
+    }
+# endif
+#endif
+
+    // Index of the first differing byte in [0, n), or n if both ranges match
+    inline size_t mismatch_bytes(const void *lhs, const void *rhs, size_t n)
+    {
+        const unsigned char *a = static_cast<const unsigned char*>(lhs);
+        const unsigned char *b = static_cast<const unsigned char*>(rhs);
+        size_t i = 0;
+
+#ifdef FT_SIMD_X86
+        if (has_avx2())
+            i = _mismatch_bytes_avx2(a, b, n);
+#endif
+#ifdef __SSE2__
+        i += _mismatch_bytes_sse2(a + i, b + i, n - i);
+#endif
+        while (i < n && a[i] == b[i])
+            ++i;
+        return i;
+    }
+
+    // Index of the first i for which !(a[i] == b[i]), or n
+    template <class T>
+    size_t mismatch(const T *a, const T *b, size_t n)
+    {
+        size_t i = 0;
+
+#ifdef FT_SIMD_X86
+        if (has_avx2())
+            i = _mismatch_avx2(a, b, n);
+#endif
+#ifdef __SSE2__
+        i += _mismatch_sse2(a + i, b + i, n - i);
+#endif
+        while (i < n && a[i] == b[i])
+            ++i;
+        return i;
+    }
+
+    // Index of the first i for which a[i] < b[i] or b[i] < a[i], or n.
+    // Unordered pairs (NaN) are skipped, as lexicographical_compare does.
+    template <class T>
+    size_t mismatch_ordered(const T *a, const T *b, size_t n)
+    {
+        size_t i = 0;
+
+#ifdef FT_SIMD_X86
+        if (has_avx2())
+            i = _mismatch_ordered_avx2(a, b, n);
+#endif
+#ifdef __SSE2__
+        i += _mismatch_ordered_sse2(a + i, b + i, n - i);
+#endif
+        while (i < n && !(a[i] < b[i]) && !(b[i] < a[i]))
+            ++i;
+        return i;
+    }
+}
+}
+
+#endif // SIMD_HPP
@@ -0,0 +1,251 @@
+#ifndef SOA_VECTOR_HPP
+#define SOA_VECTOR_HPP
+
+#include <stdexcept>
+#include <cstddef>
+#include "vector.hpp"
+
+namespace ft
+{
+    // Placeholder for the unused trailing columns of a soa_vector
+    struct soa_none {};
+
+    template <size_t I, class T0, class T1, class T2, class T3, class T4, class T5>
+    struct _soa_select;
+
+    template <class T0, class T1, class T2, class T3, class T4, class T5>
+    struct _soa_select<0, T0, T1, T2, T3, T4, T5> { typedef T0 type; };
+    template <class T0, class T1, class T2, class T3, class T4, class T5>
+    struct _soa_select<1, T0, T1, T2, T3, T4, T5> { typedef T1 type; };
+    template <class T0, class T1, class T2, class T3, class T4, class T5>
+    struct _soa_select<2, T0, T1, T2, T3, T4, T5> { typedef T2 type; };
+    template <class T0, class T1, class T2, class T3, class T4, class T5>
+    struct _soa_select<3, T0, T1, T2, T3, T4, T5> { typedef T3 type; };
+    template <class T0, class T1, class T2, class T3, class T4, class T5>
+    struct _soa_select<4, T0, T1, T2, T3, T4, T5> { typedef T4 type; };
+    template <class T0, class T1, class T2, class T3, class T4, class T5>
+    struct _soa_select<5, T0, T1, T2, T3, T4, T5> { typedef T5 type; };
+
+    // Structure of arrays: up to six fields per row, each field stored in its
+    // own ft::vector so that a scan over one field touches only that column.
+    // Rows are addressed by index; columns are reached with column<I>(),
+    // begin<I>()/end<I>() and get<I>(row).
+    template <class T0, class T1 = soa_none, class T2 = soa_none,
+              class T3 = soa_none, class T4 = soa_none, class T5 = soa_none>
+    class soa_vector
+    {
+    public:
+        typedef size_t    size_type;
+        typedef ptrdiff_t difference_type;
+
+        template <size_t I>
+        struct column_type
+        {
+            typedef typename _soa_select<I, T0, T1, T2, T3, T4, T5>::type value_type;
+            typedef ft::vector<value_type>                               container_type;
+            typedef typename container_type::reference                   reference;
+            typedef typename container_type::const_reference             const_reference;
+            typedef typename container_type::iterator                    iterator;
+            typedef typename container_type::const_iterator              const_iterator;
+        };
+
+    private:
+        ft::vector<T0> _c0;
+        ft::vector<T1> _c1;
+        ft::vector<T2> _c2;
+        ft::vector<T3> _c3;
+        ft::vector<T4> _c4;
+        ft::vector<T5> _c5;
+
+        ft::vector<T0> &_column(integral_constant<size_t, 0>) { return _c0; }
+        ft::vector<T1> &_column(integral_constant<size_t, 1>) { return _c1; }
+        ft::vector<T2> &_column(integral_constant<size_t, 2>) { return _c2; }
+        ft::vector<T3> &_column(integral_constant<size_t, 3>) { return _c3; }
+        ft::vector<T4> &_column(integral_constant<size_t, 4>) { return _c4; }
+        ft::vector<T5> &_column(integral_constant<size_t, 5>) { return _c5; }
+
+        const ft::vector<T0> &_column(integral_constant<size_t, 0>) const { return _c0; }
+        const ft::vector<T1> &_column(integral_constant<size_t, 1>) const { return _c1; }
+        const ft::vector<T2> &_column(integral_constant<size_t, 2>) const { return _c2; }
+        const ft::vector<T3> &_column(integral_constant<size_t, 3>) const { return _c3; }
+        const ft::vector<T4> &_column(integral_constant<size_t, 4>) const { return _c4; }
+        const ft::vector<T5> &_column(integral_constant<size_t, 5>) const { return _c5; }
+
+        // Column operations; soa_none columns never hold anything
+        template <class U>
+        static void _push(ft::vector<U> &c, const U &val) { c.push_back(val); }
+        static void _push(ft::vector<soa_none> &, const soa_none &) {}
+
+        template <class U>
+        static void _truncate(ft::vector<U> &c, size_type n)
+        {
+            if (c.size() > n)
+                c.erase(c.begin() + n, c.end());
+        }
+        static void _truncate(ft::vector<soa_none> &, size_type) {}
+
+        template <class U>
+        static void _resize(ft::vector<U> &c, size_type n) { c.resize(n); }
+        static void _resize(ft::vector<soa_none> &, size_type) {}
+
+        template <class U>
+        static void _reserve(ft::vector<U> &c, size_type n) { c.reserve(n); }
+        static void _reserve(ft::vector<soa_none> &, size_type) {}
+
+        template <class U>
+        static void _erase(ft::vector<U> &c, size_type first, size_type last)
+        {
+            c.erase(c.begin() + first, c.begin() + last);
+        }
+        static void _erase(ft::vector<soa_none> &, size_type, size_type) {}
+
+        template <class U>
+        static void _shrink(ft::vector<U> &c) { c.shrink_to_fit(); }
+        static void _shrink(ft::vector<soa_none> &) {}
+
+        // Brings every column back to n rows after a failed operation
+        void _truncate_all(size_type n)
+        {
+            _truncate(_c0, n);
+            _truncate(_c1, n);
+            _truncate(_c2, n);
+            _truncate(_c3, n);
+            _truncate(_c4, n);
+            _truncate(_c5, n);
+        }
+
+    public:
+        soa_vector() {}
+
+        // Capacity
+        size_type size() const { return _c0.size(); }
+
+        bool empty() const { return _c0.empty(); }
+
+        size_type capacity() const { return _c0.capacity(); }
+
+        void reserve(size_type n)
+        {
+            _reserve(_c0, n);
+            _reserve(_c1, n);
+            _reserve(_c2, n);
+            _reserve(_c3, n);
+            _reserve(_c4, n);
+            _reserve(_c5, n);
+        }
+
+        void shrink_to_fit()
+        {
+            _shrink(_c0);
+            _shrink(_c1);
+            _shrink(_c2);
+            _shrink(_c3);
+            _shrink(_c4);
+            _shrink(_c5);
+        }
+
+        void resize(size_type n)
+        {
+            size_type old_size = size();
+            try
+            {
+                _resize(_c0, n);
+                _resize(_c1, n);
+                _resize(_c2, n);
+                _resize(_c3, n);
+                _resize(_c4, n);
+                _resize(_c5, n);
+            }
+            catch (...)
+            {
+                _truncate_all(old_size);
+                throw;
+            }
+        }
+
+        // Column access
+        template <size_t I>
+        const typename column_type<I>::container_type &column() const
+        {
+            return _column(integral_constant<size_t, I>());
+        }
+
+        template <size_t I>
+        typename column_type<I>::iterator begin() { return _column(integral_constant<size_t, I>()).begin(); }
+
+        template <size_t I>
+        typename column_type<I>::const_iterator begin() const { return _column(integral_constant<size_t, I>()).begin(); }
+
+        template <size_t I>
+        typename column_type<I>::iterator end() { return _column(integral_constant<size_t, I>()).end(); }
+
+        template <size_t I>
+        typename column_type<I>::const_iterator end() const { return _column(integral_constant<size_t, I>()).end(); }
+
+        // column_type<I>::reference, so a bool column hands out its proxy
+        template <size_t I>
+        typename column_type<I>::reference get(size_type row) { return _column(integral_constant<size_t, I>())[row]; }
+
+        template <size_t I>
+        typename column_type<I>::const_reference get(size_type row) const
+        {
+            return _column(integral_constant<size_t, I>())[row];
+        }
+
+        // Modifiers
+        void push_back(const T0 &v0, const T1 &v1 = T1(), const T2 &v2 = T2(),
+                       const T3 &v3 = T3(), const T4 &v4 = T4(), const T5 &v5 = T5())
+        {
+            size_type old_size = size();
+            try
+            {
+                _push(_c0, v0);
+                _push(_c1, v1);
+                _push(_c2, v2);
+                _push(_c3, v3);
+                _push(_c4, v4);
+                _push(_c5, v5);
+            }
+            catch (...)
+            {
+                _truncate_all(old_size);
+                throw;
+            }
+        }
+
+        void pop_back()
+        {
+            if (!empty())
+                _truncate_all(size() - 1);
+        }
+
+        // Removes rows [first, last)
+        void erase(size_type first, size_type last)
+        {
+            if (first > last || last > size())
+                throw std::out_of_range("soa_vector::erase");
+            _erase(_c0, first, last);
+            _erase(_c1, first, last);
+            _erase(_c2, first, last);
+            _erase(_c3, first, last);
+            _erase(_c4, first, last);
+            _erase(_c5, first, last);
+        }
+
+        void erase(size_type row) { erase(row, row + 1); }
+
+        void clear() { _truncate_all(0); }
+
+        void swap(soa_vector &x)
+        {
+            _c0.swap(x._c0);
+            _c1.swap(x._c1);
+            _c2.swap(x._c2);
+            _c3.swap(x._c3);
+            _c4.swap(x._c4);
+            _c5.swap(x._c5);
+        }
+    };
+}
+
+#endif // SOA_VECTOR_HPP
@@ -12,6 +12,8 @@ namespace ft
 		typedef T value_type;
 		typedef Container container_type;
 		typedef size_t size_type;
+		typedef typename Container::reference reference;
+		typedef typename Container::const_reference const_reference;
 		
 		public:
 		explicit stack (const container_type& ctnr = container_type()) : _c(ctnr) {};
@@ -30,12 +32,12 @@ namespace ft
 			return (_c.size());
 		}
 
-		value_type& top()
+		reference top()
 		{
 			return (_c.back());
 		}
 		
-		const value_type& top() const
+		const_reference top() const
 		{
 			return (_c.back());
 		}
@@ -49,6 +51,17 @@ namespace ft
 		{
 			return (_c.pop_back());
 		}
+
+		// Only available when Container provides them, as ft::vector does
+		void shrink_to_fit()
+		{
+			_c.shrink_to_fit();
+		}
+
+		void set_trim_threshold(size_type divisor)
+		{
+			_c.set_trim_threshold(divisor);
+		}
 	
 		template <class TF, class CF>
 		friend
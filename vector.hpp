@@ -6,8 +6,13 @@
 #include <algorithm>
 #include <cstddef>
 #include "iterator.hpp"
+#include "aligned_allocator.hpp"
 namespace ft
 {
+    // Defined with the thread pool in parallel.hpp, which the parallel
+    // constructors need and everything else can do without
+    struct parallel_tag;
+
     template <class T, class Alloc = std::allocator<T> >
     class vector
     {
@@ -24,6 +29,9 @@ namespace ft
         // Iterator types
         class iterator : public ft::iterator<ft::random_access_iterator_tag, T>
         {
+        public:
+            typedef ft::contiguous_iterator_tag iterator_concept;
+            
         private:
             pointer _ptr;
         
@@ -139,6 +147,9 @@ namespace ft
         
         class const_iterator : public ft::iterator<ft::random_access_iterator_tag, const T>
         {
+        public:
+            typedef ft::contiguous_iterator_tag iterator_concept;
+            
         private:
             const_pointer _ptr;
         
@@ -262,15 +273,205 @@ namespace ft
         pointer         _start;
         pointer         _finish;
         pointer         _end_of_storage;
+        size_type       _trim_divisor;
+        
+        // Fills the freshly allocated [_start, _start + n); on a throw,
+        // parallel_construct has already destroyed every element and only
+        // the buffer is left to release. Found by argument-dependent lookup
+        // once parallel.hpp is included.
+        void _parallel_construct(const parallel_tag &tag, const_pointer src, const value_type *val, size_type n)
+        {
+            try
+            {
+                parallel_construct(tag, _alloc, _start, n, src, val);
+            }
+            catch (...)
+            {
+                _alloc.deallocate(_start, n);
+                throw;
+            }
+            _finish = _start + n;
+        }
+        
+        // Sources for _append: each call yields the next element to copy.
+        // The element is copied out before the iterator moves on, since
+        // some iterators hand out references into themselves.
+        template <class ForwardIterator>
+        struct _range_source
+        {
+            ForwardIterator it;
+            
+            explicit _range_source(ForwardIterator first) : it(first) {}
+            
+            value_type operator()()
+            {
+                value_type val = *it;
+                ++it;
+                return val;
+            }
+        };
+        
+        struct _value_source
+        {
+            const value_type &val;
+            
+            explicit _value_source(const value_type &v) : val(v) {}
+            
+            const value_type &operator()() const { return val; }
+        };
+        
+        // Appends n elements taken from next(), keeping push_back's doubling
+        // so repeated appends stay amortized O(1). On growth the new buffer
+        // is filled before the old one is released, so next() may read
+        // elements of this vector; on a throw the vector is left as it was.
+        template <class Source>
+        void _append(size_type n, Source next)
+        {
+            if (size() + n <= capacity())
+            {
+                pointer old_finish = _finish;
+                try
+                {
+                    while (n--)
+                    {
+                        _alloc.construct(_finish, next());
+                        ++_finish;
+                    }
+                }
+                catch (...)
+                {
+                    while (_finish != old_finish)
+                        _alloc.destroy(--_finish);
+                    throw;
+                }
+                return;
+            }
+            
+            if (n > max_size() - size())
+                throw std::length_error("vector::_append");
+            
+            size_type new_capacity = capacity() * 2;
+            if (new_capacity < size() + n)
+                new_capacity = size() + n;
+            if (new_capacity > max_size())
+                new_capacity = max_size();
+            
+            pointer new_start = _alloc.allocate(new_capacity);
+            pointer new_finish = new_start;
+            
+            try
+            {
+                for (pointer p = _start; p != _finish; ++p)
+                {
+                    _alloc.construct(new_finish, *p);
+                    ++new_finish;
+                }
+                while (n--)
+                {
+                    _alloc.construct(new_finish, next());
+                    ++new_finish;
+                }
+            }
+            catch (...)
+            {
+                for (pointer p = new_start; p != new_finish; ++p)
+                    _alloc.destroy(p);
+                _alloc.deallocate(new_start, new_capacity);
+                throw;
+            }
+            
+            for (pointer p = _start; p != _finish; ++p)
+                _alloc.destroy(p);
+            if (_start)
+                _alloc.deallocate(_start, capacity());
+            
+            _start = new_start;
+            _finish = new_finish;
+            _end_of_storage = _start + new_capacity;
+        }
+        
+        // A single-pass range cannot be measured first: one element at a time
+        template <class InputIterator>
+        void _append_range(InputIterator first, InputIterator last, std::input_iterator_tag)
+        {
+            for (; first != last; ++first)
+                push_back(*first);
+        }
+        
+        template <class ForwardIterator>
+        void _append_range(ForwardIterator first, ForwardIterator last, std::forward_iterator_tag)
+        {
+            _append(ft::distance(first, last), _range_source<ForwardIterator>(first));
+        }
+        
+        void _destroy_elements()
+        {
+            for (pointer p = _start; p != _finish; ++p)
+                _alloc.destroy(p);
+            _finish = _start;
+        }
+        
+        // Moves the elements into a buffer of exactly n slots (n >= size());
+        // n == 0 releases the storage. Leaves the vector untouched on throw.
+        void _reallocate(size_type n)
+        {
+            pointer new_start = n ? _alloc.allocate(n) : NULL;
+            pointer new_finish = new_start;
+            
+            try
+            {
+                for (pointer p = _start; p != _finish; ++p)
+                {
+                    _alloc.construct(new_finish, *p);
+                    ++new_finish;
+                }
+            }
+            catch (...)
+            {
+                for (pointer p = new_start; p != new_finish; ++p)
+                    _alloc.destroy(p);
+                if (new_start)
+                    _alloc.deallocate(new_start, n);
+                throw;
+            }
+            
+            for (pointer p = _start; p != _finish; ++p)
+                _alloc.destroy(p);
+            
+            if (_start)
+                _alloc.deallocate(_start, capacity());
+            
+            _start = new_start;
+            _finish = new_finish;
+            _end_of_storage = _start + n;
+        }
+        
+        // Best effort: a failed shrink leaves the vector as it was
+        void _trim_if_sparse()
+        {
+            if (!_trim_divisor || size() * _trim_divisor >= capacity())
+                return;
+            
+            size_type target = size() * 2;
+            if (target >= capacity())
+                return;
+            try
+            {
+                _reallocate(target);
+            }
+            catch (...)
+            {
+            }
+        }
         
     public:
         // Constructors
         explicit vector(const allocator_type &alloc = allocator_type())
-            : _alloc(alloc), _start(NULL), _finish(NULL), _end_of_storage(NULL) {}
+            : _alloc(alloc), _start(NULL), _finish(NULL), _end_of_storage(NULL), _trim_divisor(0) {}
         
         explicit vector(size_type n, const value_type &val = value_type(),
                        const allocator_type &alloc = allocator_type())
-            : _alloc(alloc)
+            : _alloc(alloc), _trim_divisor(0)
         {
             _start = _alloc.allocate(n);
             _finish = _start;
@@ -284,7 +485,7 @@ namespace ft
         vector(InputIterator first, InputIterator last,
               const allocator_type &alloc = allocator_type(),
               typename ft::enable_if<!ft::is_integral<InputIterator>::value, InputIterator>::type* = 0)
-            : _alloc(alloc)
+            : _alloc(alloc), _trim_divisor(0)
         {
             difference_type n = ft::distance(first, last);
             
@@ -296,7 +497,7 @@ namespace ft
                 _alloc.construct(_finish++, *first++);
         }
         
-        vector(const vector &x) : _alloc(x._alloc)
+        vector(const vector &x) : _alloc(x._alloc), _trim_divisor(x._trim_divisor)
         {
             size_type n = x.size();
             
@@ -309,10 +510,35 @@ namespace ft
                 _alloc.construct(_finish++, *src++);
         }
         
+        // Opt-in parallel variants of the fill and copy constructors; pass
+        // ft::parallel from parallel.hpp
+        vector(size_type n, const value_type &val, const ft::parallel_tag &tag,
+               const allocator_type &alloc = allocator_type())
+            : _alloc(alloc), _trim_divisor(0)
+        {
+            _start = _alloc.allocate(n);
+            _finish = _start;
+            _end_of_storage = _start + n;
+            
+            _parallel_construct(tag, NULL, &val, n);
+        }
+        
+        vector(const vector &x, const ft::parallel_tag &tag)
+            : _alloc(x._alloc), _trim_divisor(x._trim_divisor)
+        {
+            size_type n = x.size();
+            
+            _start = _alloc.allocate(n);
+            _finish = _start;
+            _end_of_storage = _start + n;
+            
+            _parallel_construct(tag, x._start, NULL, n);
+        }
+        
         // Destructor
         ~vector()
         {
-            clear();
+            _destroy_elements();
             if (_start)
                 _alloc.deallocate(_start, capacity());
         }
@@ -322,8 +548,8 @@ namespace ft
         {
             if (this != &x)
             {
-                clear();
                 assign(x.begin(), x.end());
+                _trim_divisor = x._trim_divisor;
             }
             return *this;
         }
@@ -368,37 +594,27 @@ namespace ft
                 throw std::length_error("vector::reserve");
             
             if (n > capacity())
-            {
-                pointer new_start = _alloc.allocate(n);
-                pointer new_finish = new_start;
-                
-                try
-                {
-                    for (pointer p = _start; p != _finish; ++p)
-                    {
-                        _alloc.construct(new_finish, *p);
-                        ++new_finish;
-                    }
-                }
-                catch (...)
-                {
-                    for (pointer p = new_start; p != new_finish; ++p)
-                        _alloc.destroy(p);
-                    _alloc.deallocate(new_start, n);
-                    throw;
-                }
-                
-                for (pointer p = _start; p != _finish; ++p)
-                    _alloc.destroy(p);
-                
-                if (_start)
-                    _alloc.deallocate(_start, capacity());
-                
-                _start = new_start;
-                _finish = new_finish;
-                _end_of_storage = _start + n;
-            }
+                _reallocate(n);
+        }
+        
+        // Releases the unused capacity
+        void shrink_to_fit()
+        {
+            if (capacity() > size())
+                _reallocate(size());
+        }
+        
+        // Automatic trimming: once size() * divisor < capacity() after an
+        // erase, pop_back or clear, capacity drops to twice the size.
+        // 0 (the default) turns it off. 1 and 2 count as 3: below that,
+        // trimming to twice the size would let every pop_back reallocate.
+        // The threshold travels with the contents: copies, assignment and
+        // swap all take it from the source.
+        void set_trim_threshold(size_type divisor)
+        {
+            _trim_divisor = divisor && divisor < 3 ? 3 : divisor;
         }
+        size_type trim_threshold() const { return _trim_divisor; }
         
         // Element access
         reference operator[](size_type n) { return _start[n]; }
@@ -424,12 +640,19 @@ namespace ft
         reference back() { return *(_finish - 1); }
         const_reference back() const { return *(_finish - 1); }
         
+        pointer data() { return _start; }
+        const_pointer data() const { return _start; }
+        
+        // Byte boundary data() is guaranteed to start on, as promised by the
+        // allocator (see aligned_allocator)
+        static size_type alignment() { return ft::allocator_alignment<allocator_type>::value; }
+        
         // Modifiers
         template <class InputIterator>
         void assign(InputIterator first, InputIterator last,
                    typename ft::enable_if<!ft::is_integral<InputIterator>::value, InputIterator>::type* = 0)
         {
-            clear();
+            _destroy_elements();
             
             difference_type n = ft::distance(first, last);
             
@@ -449,7 +672,7 @@ namespace ft
         
         void assign(size_type n, const value_type &val)
         {
-            clear();
+            _destroy_elements();
             
             if (n > capacity())
             {
@@ -467,14 +690,29 @@ namespace ft
         
         void push_back(const value_type &val)
         {
-            if (_finish == _end_of_storage)
+            if (_finish != _end_of_storage)
             {
-                size_type new_capacity = capacity() == 0 ? 1 : capacity() * 2;
-                reserve(new_capacity);
+                _alloc.construct(_finish, val);
+                ++_finish;
             }
-            
-            _alloc.construct(_finish, val);
-            ++_finish;
+            else
+                _append(1, _value_source(val));
+        }
+        
+        // Appends n values produced by gen(), constructed in place after a
+        // single capacity check
+        template <class Generator>
+        void append(size_type n, Generator gen)
+        {
+            _append(n, gen);
+        }
+        
+        // The range may lie within this vector
+        template <class InputIterator>
+        void append_range(InputIterator first, InputIterator last,
+                         typename ft::enable_if<!ft::is_integral<InputIterator>::value, InputIterator>::type* = 0)
+        {
+            _append_range(first, last, typename ft::iterator_traits<InputIterator>::iterator_category());
         }
         
         void pop_back()
@@ -483,6 +721,7 @@ namespace ft
             {
                 --_finish;
                 _alloc.destroy(_finish);
+                _trim_if_sparse();
             }
         }
         
@@ -666,6 +905,12 @@ namespace ft
             --_finish;
             _alloc.destroy(_finish);
             
+            if (_trim_divisor)
+            {
+                size_type pos_index = position - begin();
+                _trim_if_sparse();
+                return begin() + pos_index;
+            }
             return position;
         }
         
@@ -692,6 +937,12 @@ namespace ft
             
             _finish = _start + (new_end - begin());
             
+            if (_trim_divisor)
+            {
+                size_type pos_index = result - begin();
+                _trim_if_sparse();
+                return begin() + pos_index;
+            }
             return result;
         }
         
@@ -701,13 +952,13 @@ namespace ft
             ft::swap(_finish, x._finish);
             ft::swap(_end_of_storage, x._end_of_storage);
             ft::swap(_alloc, x._alloc);
+            ft::swap(_trim_divisor, x._trim_divisor);
         }
         
         void clear()
         {
-            for (pointer p = _start; p != _finish; ++p)
-                _alloc.destroy(p);
-            _finish = _start;
+            _destroy_elements();
+            _trim_if_sparse();
         }
         
         // Allocator
@@ -716,4 +967,6 @@ namespace ft
     
 }
 
+#include "vector_bool.hpp"
+
 #endif // VECTOR_HPP
\ No newline at end of file
@@ -0,0 +1,852 @@
+#ifndef VECTOR_BOOL_HPP
+#define VECTOR_BOOL_HPP
+
+#include <memory>
+#include <stdexcept>
+#include <cstddef>
+#include <climits>
+#include <cstring>
+#include "iterator.hpp"
+#include "simd.hpp"
+#include "vector.hpp"
+
+namespace ft
+{
+    typedef unsigned long bit_word;
+
+    const size_t bit_word_size = sizeof(bit_word) * CHAR_BIT;
+
+    // Proxy returned by vector<bool>::operator[] and iterators
+    class bit_reference
+    {
+    private:
+        bit_word *_word;
+        bit_word _mask;
+
+    public:
+        bit_reference(bit_word *word, bit_word mask) : _word(word), _mask(mask) {}
+
+        operator bool() const { return (*_word & _mask) != 0; }
+
+        bit_reference &operator=(bool x)
+        {
+            if (x)
+                *_word |= _mask;
+            else
+                *_word &= ~_mask;
+            return *this;
+        }
+
+        bit_reference &operator=(const bit_reference &x) { return *this = bool(x); }
+
+        bool operator~() const { return !bool(*this); }
+
+        void flip() { *_word ^= _mask; }
+
+        friend bool operator==(const bit_reference &lhs, const bit_reference &rhs)
+        {
+            return bool(lhs) == bool(rhs);
+        }
+
+        friend bool operator!=(const bit_reference &lhs, const bit_reference &rhs)
+        {
+            return bool(lhs) != bool(rhs);
+        }
+
+        friend bool operator<(const bit_reference &lhs, const bit_reference &rhs)
+        {
+            return !bool(lhs) && bool(rhs);
+        }
+    };
+
+    // Swaps the referenced bits; proxies are passed by value
+    inline void swap(bit_reference x, bit_reference y)
+    {
+        bool tmp = x;
+        x = y;
+        y = tmp;
+    }
+
+    // Position of a bit: a word and an offset inside it
+    class bit_iterator_base
+    {
+    protected:
+        bit_word *_p;
+        size_t   _offset;
+
+        bit_iterator_base(bit_word *p, size_t offset) : _p(p), _offset(offset) {}
+
+        void _bump_up()
+        {
+            if (_offset++ == bit_word_size - 1)
+            {
+                _offset = 0;
+                ++_p;
+            }
+        }
+
+        void _bump_down()
+        {
+            if (_offset-- == 0)
+            {
+                _offset = bit_word_size - 1;
+                --_p;
+            }
+        }
+
+        void _advance(ptrdiff_t i)
+        {
+            ptrdiff_t n = i + static_cast<ptrdiff_t>(_offset);
+            ptrdiff_t w = static_cast<ptrdiff_t>(bit_word_size);
+
+            _p += n / w;
+            n = n % w;
+            if (n < 0)
+            {
+                n += w;
+                --_p;
+            }
+            _offset = static_cast<size_t>(n);
+        }
+
+        ptrdiff_t _distance(const bit_iterator_base &from) const
+        {
+            return static_cast<ptrdiff_t>(bit_word_size) * (_p - from._p)
+                   + static_cast<ptrdiff_t>(_offset) - static_cast<ptrdiff_t>(from._offset);
+        }
+
+        bool _equal(const bit_iterator_base &x) const { return _p == x._p && _offset == x._offset; }
+
+        bool _less(const bit_iterator_base &x) const
+        {
+            return _p < x._p || (_p == x._p && _offset < x._offset);
+        }
+
+    public:
+        bit_word *word() const { return _p; }
+        size_t offset() const { return _offset; }
+    };
+
+    class bit_iterator : public bit_iterator_base
+    {
+    public:
+        typedef ft::random_access_iterator_tag iterator_category;
+        typedef bool                           value_type;
+        typedef ptrdiff_t                      difference_type;
+        typedef bit_reference                  reference;
+        typedef bit_reference*                 pointer;
+
+        bit_iterator() : bit_iterator_base(NULL, 0) {}
+        bit_iterator(bit_word *p, size_t offset) : bit_iterator_base(p, offset) {}
+
+        reference operator*() const { return reference(_p, bit_word(1) << _offset); }
+        reference operator[](difference_type n) const { return *(*this + n); }
+
+        bit_iterator &operator++()
+        {
+            _bump_up();
+            return *this;
+        }
+
+        bit_iterator operator++(int)
+        {
+            bit_iterator tmp(*this);
+            _bump_up();
+            return tmp;
+        }
+
+        bit_iterator &operator--()
+        {
+            _bump_down();
+            return *this;
+        }
+
+        bit_iterator operator--(int)
+        {
+            bit_iterator tmp(*this);
+            _bump_down();
+            return tmp;
+        }
+
+        bit_iterator &operator+=(difference_type n)
+        {
+            _advance(n);
+            return *this;
+        }
+
+        bit_iterator &operator-=(difference_type n)
+        {
+            _advance(-n);
+            return *this;
+        }
+
+        bit_iterator operator+(difference_type n) const
+        {
+            bit_iterator tmp(*this);
+            return tmp += n;
+        }
+
+        bit_iterator operator-(difference_type n) const
+        {
+            bit_iterator tmp(*this);
+            return tmp -= n;
+        }
+
+        friend bit_iterator operator+(difference_type n, const bit_iterator &it) { return it + n; }
+
+        friend difference_type operator-(const bit_iterator &lhs, const bit_iterator &rhs)
+        {
+            return lhs._distance(rhs);
+        }
+
+        friend bool operator==(const bit_iterator &lhs, const bit_iterator &rhs) { return lhs._equal(rhs); }
+        friend bool operator!=(const bit_iterator &lhs, const bit_iterator &rhs) { return !lhs._equal(rhs); }
+        friend bool operator<(const bit_iterator &lhs, const bit_iterator &rhs) { return lhs._less(rhs); }
+        friend bool operator>(const bit_iterator &lhs, const bit_iterator &rhs) { return rhs._less(lhs); }
+        friend bool operator<=(const bit_iterator &lhs, const bit_iterator &rhs) { return !rhs._less(lhs); }
+        friend bool operator>=(const bit_iterator &lhs, const bit_iterator &rhs) { return !lhs._less(rhs); }
+    };
+
+    class bit_const_iterator : public bit_iterator_base
+    {
+    public:
+        typedef ft::random_access_iterator_tag iterator_category;
+        typedef bool                           value_type;
+        typedef ptrdiff_t                      difference_type;
+        typedef bool                           reference;
+        typedef const bool*                    pointer;
+
+        bit_const_iterator() : bit_iterator_base(NULL, 0) {}
+        bit_const_iterator(const bit_word *p, size_t offset)
+            : bit_iterator_base(const_cast<bit_word*>(p), offset) {}
+        bit_const_iterator(const bit_iterator &it) : bit_iterator_base(it.word(), it.offset()) {}
+
+        reference operator*() const { return (*_p & (bit_word(1) << _offset)) != 0; }
+        reference operator[](difference_type n) const { return *(*this + n); }
+
+        bit_const_iterator &operator++()
+        {
+            _bump_up();
+            return *this;
+        }
+
+        bit_const_iterator operator++(int)
+        {
+            bit_const_iterator tmp(*this);
+            _bump_up();
+            return tmp;
+        }
+
+        bit_const_iterator &operator--()
+        {
+            _bump_down();
+            return *this;
+        }
+
+        bit_const_iterator operator--(int)
+        {
+            bit_const_iterator tmp(*this);
+            _bump_down();
+            return tmp;
+        }
+
+        bit_const_iterator &operator+=(difference_type n)
+        {
+            _advance(n);
+            return *this;
+        }
+
+        bit_const_iterator &operator-=(difference_type n)
+        {
+            _advance(-n);
+            return *this;
+        }
+
+        bit_const_iterator operator+(difference_type n) const
+        {
+            bit_const_iterator tmp(*this);
+            return tmp += n;
+        }
+
+        bit_const_iterator operator-(difference_type n) const
+        {
+            bit_const_iterator tmp(*this);
+            return tmp -= n;
+        }
+
+        friend bit_const_iterator operator+(difference_type n, const bit_const_iterator &it) { return it + n; }
+
+        friend difference_type operator-(const bit_const_iterator &lhs, const bit_const_iterator &rhs)
+        {
+            return lhs._distance(rhs);
+        }
+
+        friend bool operator==(const bit_const_iterator &lhs, const bit_const_iterator &rhs) { return lhs._equal(rhs); }
+        friend bool operator!=(const bit_const_iterator &lhs, const bit_const_iterator &rhs) { return !lhs._equal(rhs); }
+        friend bool operator<(const bit_const_iterator &lhs, const bit_const_iterator &rhs) { return lhs._less(rhs); }
+        friend bool operator>(const bit_const_iterator &lhs, const bit_const_iterator &rhs) { return rhs._less(lhs); }
+        friend bool operator<=(const bit_const_iterator &lhs, const bit_const_iterator &rhs) { return !rhs._less(lhs); }
+        friend bool operator>=(const bit_const_iterator &lhs, const bit_const_iterator &rhs) { return !lhs._less(rhs); }
+    };
+
+    // Bit-packed vector<bool>: one bit per element, stored in bit_word
+    // words. Bits past size() are always zero, so count, comparisons and the
+    // bitwise operators can work a whole word at a time.
+    template <class Alloc>
+    class vector<bool, Alloc>
+    {
+    public:
+        typedef bool                                 value_type;
+        typedef Alloc                                allocator_type;
+        typedef bit_reference                        reference;
+        typedef bool                                 const_reference;
+        typedef bit_reference*                       pointer;
+        typedef const bool*                          const_pointer;
+        typedef ptrdiff_t                            difference_type;
+        typedef size_t                               size_type;
+        typedef bit_iterator                         iterator;
+        typedef bit_const_iterator                   const_iterator;
+        typedef ft::reverse_iterator<iterator>       reverse_iterator;
+        typedef ft::reverse_iterator<const_iterator> const_reverse_iterator;
+
+        // Returned by find_first/find_next when no bit is set
+        static const size_type npos = static_cast<size_type>(-1);
+
+    private:
+        typedef typename allocator_type::template rebind<bit_word>::other word_allocator_type;
+
+        word_allocator_type _alloc;
+        bit_word            *_words;
+        size_type           _size;
+        size_type           _nwords;
+        size_type           _trim_divisor;
+
+        static size_type _words_for(size_type n) { return (n + bit_word_size - 1) / bit_word_size; }
+
+        size_type _used_words() const { return _words_for(_size); }
+
+        bool _get(size_type i) const
+        {
+            return (_words[i / bit_word_size] >> (i % bit_word_size)) & 1;
+        }
+
+        void _set(size_type i, bool x)
+        {
+            bit_word mask = bit_word(1) << (i % bit_word_size);
+            if (x)
+                _words[i / bit_word_size] |= mask;
+            else
+                _words[i / bit_word_size] &= ~mask;
+        }
+
+        // Moves the bits into a zeroed buffer of nwords words
+        void _reallocate(size_type nwords)
+        {
+            bit_word *words = nwords ? _alloc.allocate(nwords) : NULL;
+
+            if (nwords)
+                std::memset(words, 0, nwords * sizeof(bit_word));
+            if (_size)
+                std::memcpy(words, _words, _used_words() * sizeof(bit_word));
+            if (_words)
+                _alloc.deallocate(_words, _nwords);
+            _words = words;
+            _nwords = nwords;
+        }
+
+        // Room for n more bits, doubling like the primary template
+        void _reserve_for_append(size_type n)
+        {
+            if (_size + n <= capacity())
+                return;
+
+            size_type new_capacity = capacity() * 2;
+            if (new_capacity < _size + n)
+                new_capacity = _size + n;
+            reserve(new_capacity);
+        }
+
+        // Same policy as the primary template's set_trim_threshold
+        void _trim_if_sparse()
+        {
+            if (!_trim_divisor || _size * _trim_divisor >= capacity())
+                return;
+
+            size_type target = _words_for(_size * 2);
+            if (target >= _nwords)
+                return;
+            try
+            {
+                _reallocate(target);
+            }
+            catch (...)
+            {
+            }
+        }
+
+        void _copy_words(const vector &x)
+        {
+            if (x._size)
+            {
+                _reallocate(x._used_words());
+                std::memcpy(_words, x._words, x._used_words() * sizeof(bit_word));
+                _size = x._size;
+            }
+        }
+
+        // clear() without the trim, for assign and operator= which are
+        // about to refill the buffer
+        void _clear_bits()
+        {
+            if (_size)
+                std::memset(_words, 0, _used_words() * sizeof(bit_word));
+            _size = 0;
+        }
+
+        // Shrinks to n bits, clearing the dropped ones
+        void _truncate(size_type n)
+        {
+            while (_size > n && _size % bit_word_size)
+                _set(--_size, false);
+            if (_size > n)
+            {
+                size_type keep = _words_for(n);
+                std::memset(_words + keep, 0, (_used_words() - keep) * sizeof(bit_word));
+                _size = keep * bit_word_size;
+                while (_size > n)
+                    _set(--_size, false);
+            }
+        }
+
+        // Opens a gap of n bits at index pos, shifting the tail up
+        void _open_gap(size_type pos, size_type n)
+        {
+            _reserve_for_append(n);
+            size_type old_size = _size;
+            _size += n;
+            for (size_type i = old_size; i-- > pos;)
+                _set(i + n, _get(i));
+        }
+
+    public:
+        // Constructors
+        explicit vector(const allocator_type &alloc = allocator_type())
+            : _alloc(alloc), _words(NULL), _size(0), _nwords(0), _trim_divisor(0) {}
+
+        explicit vector(size_type n, const value_type &val = value_type(),
+                        const allocator_type &alloc = allocator_type())
+            : _alloc(alloc), _words(NULL), _size(0), _nwords(0), _trim_divisor(0)
+        {
+            assign(n, val);
+        }
+
+        template <class InputIterator>
+        vector(InputIterator first, InputIterator last,
+               const allocator_type &alloc = allocator_type(),
+               typename ft::enable_if<!ft::is_integral<InputIterator>::value, InputIterator>::type* = 0)
+            : _alloc(alloc), _words(NULL), _size(0), _nwords(0), _trim_divisor(0)
+        {
+            assign(first, last);
+        }
+
+        vector(const vector &x)
+            : _alloc(x._alloc), _words(NULL), _size(0), _nwords(0), _trim_divisor(x._trim_divisor)
+        {
+            _copy_words(x);
+        }
+
+        // The parallel constructors exist so that code written against
+        // ft::vector<T> also compiles for bool. A fill or copy is a single
+        // memset/memcpy over size() / 64 words, so they run serially.
+        vector(size_type n, const value_type &val, const ft::parallel_tag &,
+               const allocator_type &alloc = allocator_type())
+            : _alloc(alloc), _words(NULL), _size(0), _nwords(0), _trim_divisor(0)
+        {
+            assign(n, val);
+        }
+
+        vector(const vector &x, const ft::parallel_tag &)
+            : _alloc(x._alloc), _words(NULL), _size(0), _nwords(0), _trim_divisor(x._trim_divisor)
+        {
+            _copy_words(x);
+        }
+
+        // Destructor
+        ~vector()
+        {
+            if (_words)
+                _alloc.deallocate(_words, _nwords);
+        }
+
+        // Assignment operator
+        vector &operator=(const vector &x)
+        {
+            if (this != &x)
+            {
+                _clear_bits();
+                if (x._size > capacity())
+                    _reallocate(x._used_words());
+                if (x._size)
+                    std::memcpy(_words, x._words, x._used_words() * sizeof(bit_word));
+                _size = x._size;
+                _trim_divisor = x._trim_divisor;
+            }
+            return *this;
+        }
+
+        // Iterators
+        iterator begin() { return iterator(_words, 0); }
+        const_iterator begin() const { return const_iterator(_words, 0); }
+
+        iterator end() { return iterator(_words + _size / bit_word_size, _size % bit_word_size); }
+        const_iterator end() const { return const_iterator(_words + _size / bit_word_size, _size % bit_word_size); }
+
+        reverse_iterator rbegin() { return reverse_iterator(end()); }
+        const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+
+        reverse_iterator rend() { return reverse_iterator(begin()); }
+        const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+        // Capacity
+        size_type size() const { return _size; }
+
+        size_type max_size() const
+        {
+            size_type words = _alloc.max_size();
+            size_type limit = static_cast<size_type>(-1) / bit_word_size;
+            return (words < limit ? words : limit) * bit_word_size;
+        }
+
+        void resize(size_type n, value_type val = value_type())
+        {
+            if (n < _size)
+                _truncate(n);
+            else if (n > _size)
+                insert(end(), n - _size, val);
+        }
+
+        size_type capacity() const { return _nwords * bit_word_size; }
+
+        bool empty() const { return _size == 0; }
+
+        void reserve(size_type n)
+        {
+            if (n > max_size())
+                throw std::length_error("vector<bool>::reserve");
+
+            if (n > capacity())
+                _reallocate(_words_for(n));
+        }
+
+        void shrink_to_fit()
+        {
+            if (_nwords > _used_words())
+                _reallocate(_used_words());
+        }
+
+        void set_trim_threshold(size_type divisor)
+        {
+            _trim_divisor = divisor && divisor < 3 ? 3 : divisor;
+        }
+        size_type trim_threshold() const { return _trim_divisor; }
+
+        // Element access
+        reference operator[](size_type n)
+        {
+            return reference(_words + n / bit_word_size, bit_word(1) << (n % bit_word_size));
+        }
+
+        const_reference operator[](size_type n) const { return _get(n); }
+
+        reference at(size_type n)
+        {
+            if (n >= _size)
+                throw std::out_of_range("vector<bool>::at");
+            return (*this)[n];
+        }
+
+        const_reference at(size_type n) const
+        {
+            if (n >= _size)
+                throw std::out_of_range("vector<bool>::at");
+            return _get(n);
+        }
+
+        reference front() { return (*this)[0]; }
+        const_reference front() const { return _get(0); }
+
+        reference back() { return (*this)[_size - 1]; }
+        const_reference back() const { return _get(_size - 1); }
+
+        // Modifiers
+        template <class InputIterator>
+        void assign(InputIterator first, InputIterator last,
+                    typename ft::enable_if<!ft::is_integral<InputIterator>::value, InputIterator>::type* = 0)
+        {
+            _clear_bits();
+            reserve(ft::distance(first, last));
+            for (; first != last; ++first)
+                _set(_size++, *first);
+        }
+
+        void assign(size_type n, const value_type &val)
+        {
+            _clear_bits();
+            reserve(n);
+            if (val && n)
+            {
+                std::memset(_words, 0xFF, (n / bit_word_size) * sizeof(bit_word));
+                if (n % bit_word_size)
+                    _words[n / bit_word_size] = (bit_word(1) << (n % bit_word_size)) - 1;
+            }
+            _size = n;
+        }
+
+        void push_back(const value_type &val)
+        {
+            _reserve_for_append(1);
+            _set(_size++, val);
+        }
+
+        // Appends n values produced by gen() after a single capacity check
+        template <class Generator>
+        void append(size_type n, Generator gen)
+        {
+            _reserve_for_append(n);
+            while (n--)
+                _set(_size++, gen());
+        }
+
+        // insert at end(), so the range may come from this vector
+        template <class InputIterator>
+        void append_range(InputIterator first, InputIterator last,
+                          typename ft::enable_if<!ft::is_integral<InputIterator>::value, InputIterator>::type* = 0)
+        {
+            _append_range(first, last, typename ft::iterator_traits<InputIterator>::iterator_category());
+        }
+
+        void pop_back()
+        {
+            if (_size)
+            {
+                _set(--_size, false);
+                _trim_if_sparse();
+            }
+        }
+
+        iterator insert(iterator position, const value_type &val)
+        {
+            size_type pos = position - begin();
+            _open_gap(pos, 1);
+            _set(pos, val);
+            return begin() + pos;
+        }
+
+        void insert(iterator position, size_type n, const value_type &val)
+        {
+            size_type pos = position - begin();
+            _open_gap(pos, n);
+            for (size_type i = 0; i < n; ++i)
+                _set(pos + i, val);
+        }
+
+        // _open_gap moves (and may reallocate) the bits, so a range over a
+        // vector<bool> is copied out first in case it is this one
+        template <class InputIterator>
+        void insert(iterator position, InputIterator first, InputIterator last,
+                    typename ft::enable_if<!ft::is_integral<InputIterator>::value, InputIterator>::type* = 0)
+        {
+            size_type pos = position - begin();
+            if (_is_bit_iterator<InputIterator>::value)
+            {
+                vector bits(first, last, get_allocator());
+                _insert_range(pos, bits.begin(), bits.end());
+            }
+            else
+                _insert_range(pos, first, last);
+        }
+
+        iterator erase(iterator position)
+        {
+            return erase(position, position + 1);
+        }
+
+        iterator erase(iterator first, iterator last)
+        {
+            size_type pos = first - begin();
+            size_type n = last - first;
+
+            for (size_type i = pos + n; i < _size; ++i)
+                _set(i - n, _get(i));
+            _truncate(_size - n);
+            _trim_if_sparse();
+            return begin() + pos;
+        }
+
+        void swap(vector &x)
+        {
+            ft::swap(_alloc, x._alloc);
+            ft::swap(_words, x._words);
+            ft::swap(_size, x._size);
+            ft::swap(_nwords, x._nwords);
+            ft::swap(_trim_divisor, x._trim_divisor);
+        }
+
+        static void swap(reference x, reference y)
+        {
+            bool tmp = x;
+            x = y;
+            y = tmp;
+        }
+
+        void flip()
+        {
+            size_type used = _used_words();
+            for (size_type i = 0; i < used; ++i)
+                _words[i] = ~_words[i];
+            if (_size % bit_word_size)
+                _words[used - 1] &= (bit_word(1) << (_size % bit_word_size)) - 1;
+        }
+
+        void clear()
+        {
+            _clear_bits();
+            _trim_if_sparse();
+        }
+
+        // Bit operations, a word at a time
+        size_type count() const { return simd::popcount(_words, _used_words()); }
+
+        size_type find_first() const { return _find_from_word(0); }
+
+        // First set bit strictly after pos
+        size_type find_next(size_type pos) const
+        {
+            if (_size == 0 || pos >= _size - 1)
+                return npos;
+            ++pos;
+
+            size_type w = pos / bit_word_size;
+            bit_word bits = _words[w] & (~bit_word(0) << (pos % bit_word_size));
+            if (bits)
+                return w * bit_word_size + __builtin_ctzl(bits);
+            return _find_from_word(w + 1);
+        }
+
+        // Element-wise AND/OR/XOR with a vector of the same size
+        vector &operator&=(const vector &x)
+        {
+            _check_same_size(x);
+            simd::and_words(_words, x._words, _used_words());
+            return *this;
+        }
+
+        vector &operator|=(const vector &x)
+        {
+            _check_same_size(x);
+            simd::or_words(_words, x._words, _used_words());
+            return *this;
+        }
+
+        vector &operator^=(const vector &x)
+        {
+            _check_same_size(x);
+            simd::xor_words(_words, x._words, _used_words());
+            return *this;
+        }
+
+        // Word storage, for comparisons and external bit kernels
+        const bit_word *words() const { return _words; }
+        size_type word_count() const { return _used_words(); }
+
+        // Allocator
+        allocator_type get_allocator() const { return allocator_type(_alloc); }
+
+    private:
+        template <class Iterator>
+        struct _is_bit_iterator
+        {
+            static const bool value = ft::is_same<Iterator, iterator>::value
+                                      || ft::is_same<Iterator, const_iterator>::value
+                                      || ft::is_same<Iterator, reverse_iterator>::value
+                                      || ft::is_same<Iterator, const_reverse_iterator>::value;
+        };
+
+        // A single-pass range cannot be measured first: one bit at a time
+        template <class InputIterator>
+        void _append_range(InputIterator first, InputIterator last, std::input_iterator_tag)
+        {
+            for (; first != last; ++first)
+                push_back(*first);
+        }
+
+        template <class ForwardIterator>
+        void _append_range(ForwardIterator first, ForwardIterator last, std::forward_iterator_tag)
+        {
+            insert(end(), first, last);
+        }
+
+        template <class InputIterator>
+        void _insert_range(size_type pos, InputIterator first, InputIterator last)
+        {
+            _open_gap(pos, ft::distance(first, last));
+            for (; first != last; ++first)
+                _set(pos++, *first);
+        }
+
+        size_type _find_from_word(size_type w) const
+        {
+            size_type used = _used_words();
+            for (; w < used; ++w)
+                if (_words[w])
+                    return w * bit_word_size + __builtin_ctzl(_words[w]);
+            return npos;
+        }
+
+        void _check_same_size(const vector &x) const
+        {
+            if (x._size != _size)
+                throw std::invalid_argument("vector<bool>: operands differ in size");
+        }
+    };
+
+    template <class Alloc>
+    const typename vector<bool, Alloc>::size_type vector<bool, Alloc>::npos;
+
+    template <class Alloc>
+    vector<bool, Alloc> operator&(const vector<bool, Alloc> &lhs, const vector<bool, Alloc> &rhs)
+    {
+        vector<bool, Alloc> result(lhs);
+        return result &= rhs;
+    }
+
+    template <class Alloc>
+    vector<bool, Alloc> operator|(const vector<bool, Alloc> &lhs, const vector<bool, Alloc> &rhs)
+    {
+        vector<bool, Alloc> result(lhs);
+        return result |= rhs;
+    }
+
+    template <class Alloc>
+    vector<bool, Alloc> operator^(const vector<bool, Alloc> &lhs, const vector<bool, Alloc> &rhs)
+    {
+        vector<bool, Alloc> result(lhs);
+        return result ^= rhs;
+    }
+
+    template <class Alloc>
+    bool operator==(const vector<bool, Alloc> &lhs, const vector<bool, Alloc> &rhs)
+    {
+        return lhs.size() == rhs.size()
+               && (lhs.size() == 0
+                   || std::memcmp(lhs.words(), rhs.words(), lhs.word_count() * sizeof(bit_word)) == 0);
+    }
+
+    template <class Alloc>
+    bool operator!=(const vector<bool, Alloc> &lhs, const vector<bool, Alloc> &rhs)
+    {
+        return !(lhs == rhs);
+    }
+}
+
+#endif // VECTOR_BOOL_HPP